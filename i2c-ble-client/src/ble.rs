@@ -80,17 +80,17 @@ impl BleClient {
         // Trim whitespace and ensure clean command
         let clean_command = command.trim();
         
+        // No logging here: stdout belongs to the TUI once it is running
         self.peripheral
             .write(config_char, clean_command.as_bytes(), WriteType::WithoutResponse)
             .await?;
         
-        println!("Sent config command: {}", clean_command);
         Ok(())
     }
 
     pub async fn subscribe_to_data<F>(&self, callback: F) -> Result<()>
     where
-        F: Fn(String) + Send + Sync + 'static,
+        F: Fn(Uuid, Vec<u8>) + Send + Sync + 'static,
     {
         let chars = self.peripheral.characteristics();
         
@@ -121,9 +121,8 @@ impl BleClient {
         
         tokio::spawn(async move {
             while let Some(data) = notification_stream.next().await {
-                if let Ok(text) = String::from_utf8(data.value.clone()) {
-                    callback(text);
-                }
+                // Raw bytes: compressed data blocks are not text
+                callback(data.uuid, data.value);
             }
         });
 
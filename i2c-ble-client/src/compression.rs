@@ -0,0 +1,237 @@
+//! Decoder for the firmware's compressed BLE transaction stream (COMPRESS ON).
+//! Mirrors `CompressedStreamReader` in `src/CompressedStream.cpp`.
+
+pub const BLOCK_MARKER: u8 = 0xC5;
+
+const SLOT_COUNT: usize = 16;
+const MAX_DATA_SIZE: usize = 32;
+
+const KIND_LITERAL: u8 = 0;
+const KIND_KEYED: u8 = 1;
+const KIND_REPEAT: u8 = 2;
+const KIND_RESET: u8 = 3;
+
+#[derive(Debug, Clone)]
+pub struct DecodedTransaction {
+    pub timestamp: u32,
+    pub bus: u8,
+    pub address: u8,
+    pub is_read: bool,
+    pub has_error: bool,
+    pub data: Vec<u8>,
+}
+
+impl DecodedTransaction {
+    /// Same layout as the firmware's text lines with FORMAT HEX.
+    pub fn to_line(&self) -> String {
+        let bus = if self.bus == 0 { String::new() } else { format!("{}:", self.bus) };
+        let mut line = format!("{} [{}0x{:02X}] ", self.timestamp, bus, self.address);
+        if self.has_error {
+            line.push_str("ERROR");
+            return line;
+        }
+
+        line.push_str(if self.is_read { "R: " } else { "W: " });
+        let bytes: Vec<String> = self.data.iter().map(|b| format!("0x{:02X}", b)).collect();
+        line.push_str(&bytes.join(" "));
+        line
+    }
+}
+
+#[derive(Debug, Clone, Default)]
+struct Slot {
+    used: bool,
+    bus: u8,
+    address: u8,
+    is_read: bool,
+    has_error: bool,
+    payload: Vec<u8>,
+}
+
+impl Slot {
+    fn transaction(&self, timestamp: u32) -> DecodedTransaction {
+        DecodedTransaction {
+            timestamp,
+            bus: self.bus,
+            address: self.address,
+            is_read: self.is_read,
+            has_error: self.has_error,
+            data: self.payload.clone(),
+        }
+    }
+}
+
+struct Cursor<'a> {
+    data: &'a [u8],
+    offset: usize,
+}
+
+impl<'a> Cursor<'a> {
+    fn is_empty(&self) -> bool {
+        self.offset >= self.data.len()
+    }
+
+    fn byte(&mut self) -> Option<u8> {
+        let value = *self.data.get(self.offset)?;
+        self.offset += 1;
+        Some(value)
+    }
+
+    fn bytes(&mut self, count: usize) -> Option<&'a [u8]> {
+        let slice = self.data.get(self.offset..self.offset + count)?;
+        self.offset += count;
+        Some(slice)
+    }
+
+    fn delta(&mut self) -> Option<i32> {
+        let mut value: u32 = 0;
+        for shift in (0..35).step_by(7) {
+            let byte = self.byte()?;
+            value |= ((byte & 0x7F) as u32) << shift;
+            if byte & 0x80 == 0 {
+                return Some((value >> 1) as i32 ^ -((value & 1) as i32));
+            }
+        }
+        None
+    }
+}
+
+pub fn is_compressed_block(data: &[u8]) -> bool {
+    data.first() == Some(&BLOCK_MARKER)
+}
+
+pub struct BlockDecoder {
+    slots: Vec<Slot>,
+    synced: bool,
+    expected_sequence: Option<u8>,
+    last_timestamp: u32,
+    pub lost_blocks: u64,
+    pub corrupt_blocks: u64,
+    pub unresolved_records: u64,
+}
+
+impl BlockDecoder {
+    pub fn new() -> Self {
+        Self {
+            slots: vec![Slot::default(); SLOT_COUNT],
+            synced: false,
+            expected_sequence: None,
+            last_timestamp: 0,
+            lost_blocks: 0,
+            corrupt_blocks: 0,
+            unresolved_records: 0,
+        }
+    }
+
+    /// Decodes one notification. Records that depend on a dictionary the
+    /// decoder has lost are counted and skipped until the next RESET.
+    pub fn feed_block(&mut self, block: &[u8]) -> Vec<DecodedTransaction> {
+        let mut decoded = Vec::new();
+        if block.len() < 2 || block[0] != BLOCK_MARKER {
+            self.corrupt_blocks += 1;
+            self.synced = false;
+            return decoded;
+        }
+
+        let sequence = block[1];
+        if let Some(expected) = self.expected_sequence {
+            if sequence != expected {
+                self.lost_blocks += sequence.wrapping_sub(expected) as u64;
+                self.synced = false;
+            }
+        }
+        self.expected_sequence = Some(sequence.wrapping_add(1));
+
+        let mut cursor = Cursor { data: block, offset: 2 };
+        while !cursor.is_empty() {
+            if self.parse_record(&mut cursor, &mut decoded).is_none() {
+                self.corrupt_blocks += 1;
+                self.synced = false;
+                break;
+            }
+        }
+        decoded
+    }
+
+    fn advance(&mut self, delta: i32) -> u32 {
+        self.last_timestamp = self.last_timestamp.wrapping_add(delta as u32);
+        self.last_timestamp
+    }
+
+    fn parse_record(&mut self, cursor: &mut Cursor, decoded: &mut Vec<DecodedTransaction>) -> Option<()> {
+        let tag = cursor.byte()?;
+        let slot = ((tag >> 2) & 0x0F) as usize;
+        let has_error = tag & 0x01 != 0;
+
+        match tag >> 6 {
+            KIND_RESET => {
+                self.slots.iter_mut().for_each(|s| *s = Slot::default());
+                self.last_timestamp = 0;
+                self.synced = true;
+            }
+            KIND_LITERAL => {
+                let delta = cursor.delta()?;
+                let address = cursor.byte()?;
+                let bus = cursor.byte()?;
+                let length = cursor.byte()? as usize;
+                if length > MAX_DATA_SIZE {
+                    return None;
+                }
+                let payload = cursor.bytes(length)?;
+
+                if self.synced {
+                    self.slots[slot] = Slot {
+                        used: true,
+                        bus,
+                        address: address >> 1,
+                        is_read: address & 0x01 != 0,
+                        has_error,
+                        payload: payload.to_vec(),
+                    };
+                    let timestamp = self.advance(delta);
+                    decoded.push(self.slots[slot].transaction(timestamp));
+                } else {
+                    self.unresolved_records += 1;
+                }
+            }
+            KIND_KEYED => {
+                let delta = cursor.delta()?;
+                let length = cursor.byte()? as usize;
+                if length == 0 || length > MAX_DATA_SIZE {
+                    return None;
+                }
+                let rest = cursor.bytes(length - 1)?;
+
+                let entry = &self.slots[slot];
+                if self.synced && entry.used && !entry.payload.is_empty() {
+                    let timestamp = self.advance(delta);
+                    let entry = &mut self.slots[slot];
+                    entry.has_error = has_error;
+                    entry.payload.truncate(1);
+                    entry.payload.extend_from_slice(rest);
+                    decoded.push(entry.transaction(timestamp));
+                } else {
+                    if self.synced {
+                        self.advance(delta);
+                    }
+                    self.unresolved_records += 1;
+                }
+            }
+            KIND_REPEAT | _ => {
+                let count = cursor.byte()?;
+                for _ in 0..count {
+                    let delta = cursor.delta()?;
+                    if self.synced {
+                        let timestamp = self.advance(delta);
+                        if self.slots[slot].used {
+                            decoded.push(self.slots[slot].transaction(timestamp));
+                            continue;
+                        }
+                    }
+                    self.unresolved_records += 1;
+                }
+            }
+        }
+        Some(())
+    }
+}
@@ -0,0 +1,176 @@
+use std::collections::VecDeque;
+use std::time::Instant;
+
+const MAX_SAMPLES: usize = 1000;
+const MAX_SYNC_SAMPLES: usize = 8;
+const MAX_PENDING_SYNCS: usize = 8;
+
+/// Latency stages, in pipeline order. Device stages come straight from the
+/// firmware stamps; host stages need the synced clock.
+pub const STAGES: [&str; 4] = ["queue", "device", "link", "total"];
+
+#[derive(Debug, Clone, Copy)]
+struct SyncSample {
+    round_trip_us: i64,
+    host_midpoint_us: i64,
+    device_us: u32,
+}
+
+/// Device stamps parsed from the " @<stop>,<dequeue>,<notify>" line trailer.
+#[derive(Debug, Clone, Copy)]
+pub struct DeviceStamps {
+    pub stop_us: u32,
+    pub dequeue_us: u32,
+    pub notify_us: u32,
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct Percentiles {
+    pub p50_us: u64,
+    pub p99_us: u64,
+}
+
+pub struct LatencyTracker {
+    epoch: Instant,
+    next_reference: u32,
+    pending_syncs: VecDeque<(u32, i64)>,
+    sync_samples: VecDeque<SyncSample>,
+    stages: [VecDeque<u64>; 4],
+}
+
+impl LatencyTracker {
+    pub fn new() -> Self {
+        Self {
+            epoch: Instant::now(),
+            next_reference: 1,
+            pending_syncs: VecDeque::new(),
+            sync_samples: VecDeque::new(),
+            stages: Default::default(),
+        }
+    }
+
+    fn host_us(&self, at: Instant) -> i64 {
+        at.duration_since(self.epoch).as_micros() as i64
+    }
+
+    /// Registers an outgoing SYNC and returns the reference to send with it.
+    pub fn begin_sync(&mut self, sent_at: Instant) -> u32 {
+        let reference = self.next_reference;
+        self.next_reference = self.next_reference.wrapping_add(1);
+
+        let sent_us = self.host_us(sent_at);
+        self.pending_syncs.push_back((reference, sent_us));
+        while self.pending_syncs.len() > MAX_PENDING_SYNCS {
+            self.pending_syncs.pop_front();
+        }
+        reference
+    }
+
+    /// Handles a "SYNC <reference> <device micros>" status line. Returns false
+    /// if the line is not a sync response.
+    pub fn handle_sync_response(&mut self, line: &str, received_at: Instant) -> bool {
+        let mut fields = line.split_whitespace();
+        if fields.next() != Some("SYNC") {
+            return false;
+        }
+        let (Some(reference), Some(device_us)) = (
+            fields.next().and_then(|f| f.parse::<u32>().ok()),
+            fields.next().and_then(|f| f.parse::<u32>().ok()),
+        ) else {
+            return false;
+        };
+
+        let Some(index) = self.pending_syncs.iter().position(|(r, _)| *r == reference) else {
+            return true;
+        };
+        let (_, sent_us) = self.pending_syncs.remove(index).unwrap();
+
+        let received_us = self.host_us(received_at);
+        let round_trip_us = received_us - sent_us;
+        self.sync_samples.push_back(SyncSample {
+            round_trip_us,
+            host_midpoint_us: sent_us + round_trip_us / 2,
+            device_us,
+        });
+        while self.sync_samples.len() > MAX_SYNC_SAMPLES {
+            self.sync_samples.pop_front();
+        }
+        true
+    }
+
+    /// The lowest round trip of the recent exchanges has the tightest bound on
+    /// when the device took its stamp.
+    fn best_sync(&self) -> Option<SyncSample> {
+        self.sync_samples.iter().copied().min_by_key(|s| s.round_trip_us)
+    }
+
+    /// Sync uncertainty: half the best round trip.
+    pub fn sync_error_us(&self) -> Option<i64> {
+        self.best_sync().map(|s| s.round_trip_us / 2)
+    }
+
+    fn device_to_host_us(&self, device_us: u32) -> Option<i64> {
+        // Device micros() wraps every ~71 minutes; offsets are taken relative
+        // to the sync point so the wrap cancels out
+        self.best_sync()
+            .map(|s| s.host_midpoint_us + device_us.wrapping_sub(s.device_us) as i32 as i64)
+    }
+
+    /// Strips the latency trailer from a data line and records its stages.
+    /// Lines without a trailer are returned unchanged.
+    pub fn handle_data_line<'a>(&mut self, line: &'a str, received_at: Instant) -> &'a str {
+        let Some((text, stamps)) = parse_stamps(line) else {
+            return line;
+        };
+
+        self.record(0, stamps.dequeue_us.wrapping_sub(stamps.stop_us) as i32 as i64);
+        self.record(1, stamps.notify_us.wrapping_sub(stamps.dequeue_us) as i32 as i64);
+
+        let received_us = self.host_us(received_at);
+        if let Some(notify_host_us) = self.device_to_host_us(stamps.notify_us) {
+            self.record(2, received_us - notify_host_us);
+        }
+        if let Some(stop_host_us) = self.device_to_host_us(stamps.stop_us) {
+            self.record(3, received_us - stop_host_us);
+        }
+        text
+    }
+
+    fn record(&mut self, stage: usize, latency_us: i64) {
+        // Sync error can push host-side stages slightly negative
+        let samples = &mut self.stages[stage];
+        samples.push_back(latency_us.max(0) as u64);
+        while samples.len() > MAX_SAMPLES {
+            samples.pop_front();
+        }
+    }
+
+    pub fn percentiles(&self, stage: usize) -> Option<Percentiles> {
+        let samples = &self.stages[stage];
+        if samples.is_empty() {
+            return None;
+        }
+
+        let mut sorted: Vec<u64> = samples.iter().copied().collect();
+        sorted.sort_unstable();
+        let at = |p: f64| sorted[((sorted.len() - 1) as f64 * p).round() as usize];
+        Some(Percentiles {
+            p50_us: at(0.50),
+            p99_us: at(0.99),
+        })
+    }
+}
+
+fn parse_stamps(line: &str) -> Option<(&str, DeviceStamps)> {
+    let (text, trailer) = line.trim_end().rsplit_once(" @")?;
+    let mut fields = trailer.split(',').map(|f| f.parse::<u32>().ok());
+    let stamps = DeviceStamps {
+        stop_us: fields.next()??,
+        dequeue_us: fields.next()??,
+        notify_us: fields.next()??,
+    };
+    if fields.next().is_some() {
+        return None;
+    }
+    Some((text, stamps))
+}
@@ -1,11 +1,19 @@
 mod ble;
+mod compression;
+mod latency;
 mod tui;
 
 use anyhow::Result;
 use clap::Parser;
+use compression::BlockDecoder;
+use latency::LatencyTracker;
+use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
 use tokio::sync::mpsc;
 use tui::{App, AppMessage};
 
+const CLOCK_SYNC_INTERVAL: Duration = Duration::from_secs(5);
+
 #[derive(Parser)]
 #[command(name = "i2c-ble-client")]
 #[command(about = "A TUI client for I2C BLE Logger")]
@@ -15,6 +23,14 @@ struct Args {
     
     #[arg(short, long)]
     scan_only: bool,
+
+    /// Don't ask the device for latency stamps
+    #[arg(long)]
+    no_latency: bool,
+
+    /// Ask the device for the compressed data stream
+    #[arg(long)]
+    compress: bool,
 }
 
 #[tokio::main]
@@ -43,6 +59,9 @@ async fn main() -> Result<()> {
     let (message_sender, message_receiver) = mpsc::unbounded_channel::<AppMessage>();
     let (command_sender, mut command_receiver) = mpsc::unbounded_channel::<String>();
 
+    let latency = Arc::new(Mutex::new(LatencyTracker::new()));
+    let decoder = Arc::new(Mutex::new(BlockDecoder::new()));
+
     // Clone sender for BLE notifications
     let ble_message_sender = message_sender.clone();
 
@@ -50,11 +69,31 @@ async fn main() -> Result<()> {
     ble_client
         .subscribe_to_data({
             let sender = ble_message_sender.clone();
-            move |data| {
-                // Determine if this is I2C data or status based on content
-                let message = if data.contains("[") && (data.contains("READ:") || data.contains("WRITE:")) {
-                    AppMessage::I2CData(data)
+            let latency = latency.clone();
+            let decoder = decoder.clone();
+            move |uuid, bytes| {
+                let received_at = Instant::now();
+                if uuid == ble::CHARACTERISTIC_UUID_TX && compression::is_compressed_block(&bytes) {
+                    let transactions = decoder.lock().unwrap().feed_block(&bytes);
+                    if !transactions.is_empty() {
+                        let lines: Vec<String> = transactions.iter().map(|t| t.to_line()).collect();
+                        let _ = sender.send(AppMessage::I2CData(lines.join("\n")));
+                    }
+                    return;
+                }
+
+                let data = String::from_utf8_lossy(&bytes).into_owned();
+                let message = if uuid == ble::CHARACTERISTIC_UUID_TX {
+                    let mut tracker = latency.lock().unwrap();
+                    let lines: Vec<&str> = data
+                        .lines()
+                        .map(|line| tracker.handle_data_line(line, received_at))
+                        .collect();
+                    AppMessage::I2CData(lines.join("\n"))
                 } else {
+                    if latency.lock().unwrap().handle_sync_response(data.trim(), received_at) {
+                        return;
+                    }
                     AppMessage::StatusUpdate(data)
                 };
                 let _ = sender.send(message);
@@ -62,6 +101,28 @@ async fn main() -> Result<()> {
         })
         .await?;
 
+    if args.compress {
+        ble_client.send_config_command("COMPRESS ON").await?;
+    }
+
+    // Periodic clock sync so device stamps can be mapped onto host time
+    if !args.no_latency {
+        let ble_client_clone = ble_client.clone();
+        let latency = latency.clone();
+        tokio::spawn(async move {
+            let _ = ble_client_clone.send_config_command("LATENCY ON").await;
+            let mut interval = tokio::time::interval(CLOCK_SYNC_INTERVAL);
+            loop {
+                interval.tick().await;
+                let reference = latency.lock().unwrap().begin_sync(Instant::now());
+                let command = format!("SYNC {}", reference);
+                if ble_client_clone.send_config_command(&command).await.is_err() {
+                    break;
+                }
+            }
+        });
+    }
+
     // Handle commands from TUI
     let ble_client_clone = ble_client.clone();
     let command_message_sender = message_sender.clone();
@@ -81,7 +142,7 @@ async fn main() -> Result<()> {
     });
 
     // Create and run TUI
-    let app = App::new(command_sender);
+    let app = App::new(command_sender, latency);
     
     println!("Starting TUI interface...");
     println!("Press 'q' to quit, 'c' to enter commands");
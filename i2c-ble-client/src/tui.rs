@@ -13,7 +13,9 @@ use ratatui::{
     widgets::{Block, Borders, List, ListItem, ListState, Paragraph, Wrap},
     Frame, Terminal,
 };
+use crate::latency::{LatencyTracker, STAGES};
 use std::io;
+use std::sync::{Arc, Mutex};
 use tokio::sync::mpsc;
 
 #[derive(Debug, Clone)]
@@ -46,6 +48,7 @@ pub struct App {
     pub command_sender: mpsc::UnboundedSender<String>,
     pub i2c_list_state: ListState,
     pub status_list_state: ListState,
+    pub latency: Arc<Mutex<LatencyTracker>>,
 }
 
 #[derive(Debug, PartialEq)]
@@ -55,7 +58,7 @@ pub enum InputMode {
 }
 
 impl App {
-    pub fn new(command_sender: mpsc::UnboundedSender<String>) -> Self {
+    pub fn new(command_sender: mpsc::UnboundedSender<String>, latency: Arc<Mutex<LatencyTracker>>) -> Self {
         Self {
             should_quit: false,
             i2c_logs: Vec::new(),
@@ -67,6 +70,7 @@ impl App {
             command_sender,
             i2c_list_state: ListState::default(),
             status_list_state: ListState::default(),
+            latency,
         }
     }
 
@@ -234,6 +238,7 @@ fn ui(f: &mut Frame, app: &mut App) {
         .direction(Direction::Vertical)
         .constraints([
             Constraint::Min(10),    // I2C Data panel
+            Constraint::Length(3),  // Latency panel
             Constraint::Length(8),  // Status panel
             Constraint::Length(3),  // Command input
             Constraint::Length(3),  // Help
@@ -243,14 +248,17 @@ fn ui(f: &mut Frame, app: &mut App) {
     // I2C Data Panel
     render_i2c_panel(f, app, chunks[0]);
     
+    // Latency Panel
+    render_latency_panel(f, app, chunks[1]);
+    
     // Status Panel
-    render_status_panel(f, app, chunks[1]);
+    render_status_panel(f, app, chunks[2]);
     
     // Command Input
-    render_command_input(f, app, chunks[2]);
+    render_command_input(f, app, chunks[3]);
     
     // Help Panel
-    render_help_panel(f, chunks[3]);
+    render_help_panel(f, chunks[4]);
 }
 
 fn render_i2c_panel(f: &mut Frame, app: &mut App, area: Rect) {
@@ -277,6 +285,34 @@ fn render_i2c_panel(f: &mut Frame, app: &mut App, area: Rect) {
     f.render_stateful_widget(list, area, &mut app.i2c_list_state);
 }
 
+fn render_latency_panel(f: &mut Frame, app: &App, area: Rect) {
+    let tracker = app.latency.lock().unwrap();
+
+    let mut spans = Vec::new();
+    for (stage, name) in STAGES.iter().enumerate() {
+        let value = match tracker.percentiles(stage) {
+            Some(p) => format!("{:.1}/{:.1}", p.p50_us as f64 / 1000.0, p.p99_us as f64 / 1000.0),
+            None => "-".to_string(),
+        };
+        spans.push(Span::styled(format!("{}: ", name), Style::default().fg(Color::Cyan)));
+        spans.push(Span::raw(format!("{}  ", value)));
+    }
+    let sync = match tracker.sync_error_us() {
+        Some(error) => format!("sync ±{:.1}", error as f64 / 1000.0),
+        None => "sync pending".to_string(),
+    };
+    spans.push(Span::styled(sync, Style::default().fg(Color::Gray)));
+
+    let panel = Paragraph::new(Line::from(spans)).block(
+        Block::default()
+            .title("Latency p50/p99 (ms): queue=STOP→dequeue, device=dequeue→notify, link=notify→host")
+            .borders(Borders::ALL)
+            .border_style(Style::default().fg(Color::Magenta)),
+    );
+
+    f.render_widget(panel, area);
+}
+
 fn render_status_panel(f: &mut Frame, app: &mut App, area: Rect) {
     let items: Vec<ListItem> = app
         .status_logs
@@ -1,17 +1,21 @@
 #include "AddressFilter.h"
 
+static const AddressRange EMPTY_RANGE = {0, 0, false, {SAMPLE_ALL, 0}, 0, 0};
+
 AddressFilter::AddressFilter() : activeRanges(0) {
     for (int i = 0; i < MAX_RANGES; i++) {
-        ranges[i] = {0, 0, false};
+        ranges[i] = EMPTY_RANGE;
+        resetSampler(i);
     }
 }
 
-bool AddressFilter::addRange(uint8_t minAddr, uint8_t maxAddr) {
-    if (activeRanges >= MAX_RANGES || !isValidRange(minAddr, maxAddr)) {
+bool AddressFilter::addRange(uint8_t minAddr, uint8_t maxAddr, SamplingPolicy policy) {
+    if (activeRanges >= MAX_RANGES || !isValidRange(minAddr, maxAddr) || !isValidPolicy(policy)) {
         return false;
     }
 
-    ranges[activeRanges] = {minAddr, maxAddr, true};
+    ranges[activeRanges] = {minAddr, maxAddr, true, policy, 0, 0};
+    resetSampler(activeRanges);
     activeRanges++;
     return true;
 }
@@ -23,34 +27,40 @@ bool AddressFilter::removeRange(int index) {
 
     for (int i = index; i < activeRanges - 1; i++) {
         ranges[i] = ranges[i + 1];
+        samplers[i] = samplers[i + 1];
     }
 
     activeRanges--;
-    ranges[activeRanges] = {0, 0, false};
+    ranges[activeRanges] = EMPTY_RANGE;
+    resetSampler(activeRanges);
     return true;
 }
 
 void AddressFilter::clearRanges() {
     activeRanges = 0;
     for (int i = 0; i < MAX_RANGES; i++) {
-        ranges[i] = {0, 0, false};
+        ranges[i] = EMPTY_RANGE;
+        resetSampler(i);
     }
 }
 
 bool AddressFilter::isAddressAllowed(uint8_t address) {
-    if (!isValidAddress(address)) {
+    return findRange(address) >= 0;
+}
+
+bool AddressFilter::admit(uint8_t address, uint32_t timestampMicros) {
+    int index = findRange(address);
+    if (index < 0) {
         return false;
     }
 
-    for (int i = 0; i < activeRanges; i++) {
-        if (ranges[i].enabled &&
-            address >= ranges[i].minAddress &&
-            address <= ranges[i].maxAddress) {
-            return true;
-        }
+    if (!sample(index, timestampMicros)) {
+        ranges[index].suppressed++;
+        return false;
     }
 
-    return false;
+    ranges[index].passed++;
+    return true;
 }
 
 int AddressFilter::getRangeCount() {
@@ -61,7 +71,7 @@ AddressRange AddressFilter::getRange(int index) {
     if (index >= 0 && index < activeRanges) {
         return ranges[index];
     }
-    return {0, 0, false};
+    return EMPTY_RANGE;
 }
 
 void AddressFilter::setRangeEnabled(int index, bool enabled) {
@@ -70,6 +80,97 @@ void AddressFilter::setRangeEnabled(int index, bool enabled) {
     }
 }
 
+bool AddressFilter::setRangePolicy(int index, SamplingPolicy policy) {
+    if (index < 0 || index >= activeRanges || !isValidPolicy(policy)) {
+        return false;
+    }
+
+    ranges[index].policy = policy;
+    ranges[index].passed = 0;
+    ranges[index].suppressed = 0;
+    resetSampler(index);
+    return true;
+}
+
+uint32_t AddressFilter::collectSuppressed(int index) {
+    if (index < 0 || index >= activeRanges) {
+        return 0;
+    }
+
+    // Only the caller advances the reported mark, so the interrupt side can
+    // keep incrementing `suppressed` without locking
+    uint32_t total = ranges[index].suppressed;
+    uint32_t delta = total - samplers[index].reportedSuppressed;
+    samplers[index].reportedSuppressed = total;
+    return delta;
+}
+
+bool AddressFilter::isValidPolicy(SamplingPolicy policy) {
+    return policy.mode == SAMPLE_ALL || policy.limit > 0;
+}
+
+int AddressFilter::findRange(uint8_t address) {
+    if (!isValidAddress(address)) {
+        return -1;
+    }
+
+    for (int i = 0; i < activeRanges; i++) {
+        if (ranges[i].enabled &&
+            address >= ranges[i].minAddress &&
+            address <= ranges[i].maxAddress) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool AddressFilter::sample(int index, uint32_t timestampMicros) {
+    const SamplingPolicy& policy = ranges[index].policy;
+    SamplerState& state = samplers[index];
+
+    switch (policy.mode) {
+        case SAMPLE_RATE: {
+            // Bucket holds one second worth of tokens
+            uint64_t capacity = (uint64_t)policy.limit * MICROS_PER_TOKEN;
+            uint32_t elapsed = timestampMicros - state.lastRefill;
+            state.lastRefill = timestampMicros;
+            if (state.counter == 0) {
+                // First transaction primes a full bucket
+                state.credit = capacity;
+                state.counter = 1;
+            } else {
+                state.credit += (uint64_t)elapsed * policy.limit;
+                if (state.credit > capacity) {
+                    state.credit = capacity;
+                }
+            }
+            if (state.credit < MICROS_PER_TOKEN) {
+                return false;
+            }
+            state.credit -= MICROS_PER_TOKEN;
+            return true;
+        }
+        case SAMPLE_DECIMATE: {
+            bool pass = state.counter == 0;
+            state.counter = (state.counter + 1) % policy.limit;
+            return pass;
+        }
+        case SAMPLE_FIRST:
+            return ranges[index].passed < policy.limit;
+        case SAMPLE_ALL:
+        default:
+            return true;
+    }
+}
+
+void AddressFilter::resetSampler(int index) {
+    samplers[index].credit = 0;
+    samplers[index].lastRefill = 0;
+    samplers[index].counter = 0;
+    samplers[index].reportedSuppressed = 0;
+}
+
 bool AddressFilter::isValidAddress(uint8_t address) {
     return address >= 0x08 && address <= 0x77;
 }
@@ -3,31 +3,65 @@
 
 #include <stdint.h>
 
+enum SamplingMode {
+    SAMPLE_ALL,       // Forward every transaction
+    SAMPLE_RATE,      // Token bucket, at most `limit` transactions per second
+    SAMPLE_DECIMATE,  // Forward 1 in every `limit` transactions
+    SAMPLE_FIRST      // Forward the first `limit` transactions, then only count
+};
+
+struct SamplingPolicy {
+    SamplingMode mode;
+    uint32_t limit;
+};
+
 struct AddressRange {
     uint8_t minAddress;
     uint8_t maxAddress;
     bool enabled;
+    SamplingPolicy policy;
+    uint32_t passed;
+    uint32_t suppressed;
 };
 
 class AddressFilter {
-private:
+public:
     static const int MAX_RANGES = 4;
+
+private:
+    static const uint64_t MICROS_PER_TOKEN = 1000000;
+
+    struct SamplerState {
+        uint64_t credit;         // Token bucket fill, in token-microseconds
+        uint32_t lastRefill;
+        uint32_t counter;
+        uint32_t reportedSuppressed;
+    };
+
     AddressRange ranges[MAX_RANGES];
+    SamplerState samplers[MAX_RANGES];
     int activeRanges;
     
 public:
     AddressFilter();
-    bool addRange(uint8_t minAddr, uint8_t maxAddr);
+    bool addRange(uint8_t minAddr, uint8_t maxAddr, SamplingPolicy policy = {SAMPLE_ALL, 0});
     bool removeRange(int index);
     void clearRanges();
     bool isAddressAllowed(uint8_t address);
+    bool admit(uint8_t address, uint32_t timestampMicros);
     int getRangeCount();
     AddressRange getRange(int index);
     void setRangeEnabled(int index, bool enabled);
+    bool setRangePolicy(int index, SamplingPolicy policy);
+    uint32_t collectSuppressed(int index);
+    static bool isValidPolicy(SamplingPolicy policy);
     
 private:
+    int findRange(uint8_t address);
+    bool sample(int index, uint32_t timestampMicros);
+    void resetSampler(int index);
     bool isValidAddress(uint8_t address);
     bool isValidRange(uint8_t minAddr, uint8_t maxAddr);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,5 +1,6 @@
 #include "BLESerial.h"
 #include <Arduino.h>
+#include <esp_gatts_api.h>
 
 const char* BLESerial::SERIAL_SERVICE_UUID = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
 const char* BLESerial::CONFIG_SERVICE_UUID = "12345678-1234-1234-1234-123456789ABC";
@@ -15,16 +16,16 @@ private:
 public:
     ServerCallbacks(BLESerial* serial) : bleSerial(serial) {}
     
-    void onConnect(BLEServer* server) {
-        bleSerial->deviceConnected = true;
-        Serial.println("[BLE] Client connected");
+    void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) {
+        bleSerial->onClientConnected(param->connect.conn_id);
+        Serial.printf("[BLE] Client %u connected\n", param->connect.conn_id);
         Serial.print("[BLE] Connection count: ");
         Serial.println(server->getConnectedCount());
     }
     
-    void onDisconnect(BLEServer* server) {
-        bleSerial->deviceConnected = false;
-        Serial.println("[BLE] Client disconnected");
+    void onDisconnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) {
+        bleSerial->onClientDisconnected(param->disconnect.conn_id);
+        Serial.printf("[BLE] Client %u disconnected\n", param->disconnect.conn_id);
         Serial.print("[BLE] Connection count: ");
         Serial.println(server->getConnectedCount());
     }
@@ -37,33 +38,12 @@ private:
 public:
     CharacteristicCallbacks(BLESerial* serial) : bleSerial(serial) {}
     
-    void onWrite(BLECharacteristic* characteristic) {
+    // Runs on BTC_TASK for every config write; no logging here, with
+    // OUTPUT BINARY the serial port carries only framed records
+    void onWrite(BLECharacteristic* characteristic, esp_ble_gatts_cb_param_t* param) {
         std::string value = characteristic->getValue();
-        String characteristicUUID = String(characteristic->getUUID().toString().c_str());
-        
-        Serial.print("[BLE] Write to characteristic: ");
-        Serial.println(characteristicUUID);
-        Serial.print("[BLE] Data length: ");
-        Serial.println(value.length());
-        Serial.print("[BLE] Data: \"");
-        Serial.print(value.c_str());
-        Serial.println("\"");
-        Serial.print("[BLE] Raw bytes: ");
-        for (size_t i = 0; i < value.length(); i++) {
-            Serial.print("0x");
-            Serial.print((uint8_t)value[i], HEX);
-            Serial.print(" ");
-        }
-        Serial.println();
-        
         if (value.length() > 0 && bleSerial->configCallback) {
-            String command = String(value.c_str());
-            Serial.println("[BLE] Calling config callback...");
-            bleSerial->configCallback(command);
-        } else if (value.length() == 0) {
-            Serial.println("[BLE] Warning: Empty command received");
-        } else if (!bleSerial->configCallback) {
-            Serial.println("[BLE] Warning: No config callback set");
+            bleSerial->configCallback(param->write.conn_id, reinterpret_cast<const uint8_t*>(value.data()), value.length());
         }
     }
 };
@@ -76,13 +56,18 @@ BLESerial::BLESerial() :
     rxCharacteristic(nullptr),
     configCharacteristic(nullptr),
     statusCharacteristic(nullptr),
-    deviceConnected(false),
-    oldDeviceConnected(false),
-    configCallback(nullptr) {
+    advertisingPending(false),
+    advertiseAfter(0),
+    configCallback(nullptr),
+    clientCallback(nullptr) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i] = {false, 0, 0, false, 0, 0};
+    }
 }
 
 bool BLESerial::begin(const char* deviceName) {
     BLEDevice::init(deviceName);
+    BLEDevice::setMTU(PREFERRED_MTU);
     
     server = BLEDevice::createServer();
     if (!server) {
@@ -148,55 +133,199 @@ void BLESerial::startAdvertising() {
     Serial.println("[BLE]   - Config: " + String(CONFIG_SERVICE_UUID));
 }
 
+void BLESerial::onClientConnected(uint16_t connId) {
+    int connected = 0;
+    bool stored = false;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (!stored && !clients[i].connected) {
+            clients[i].connId = connId;
+            clients[i].generation++;
+            clients[i].connected = true;
+            stored = true;
+        }
+        connected += clients[i].connected ? 1 : 0;
+    }
+
+    if (!stored) {
+        // More links than this logger serves; the stack allowed one too many
+        Serial.printf("[BLE] No free client slot, dropping client %u\n", connId);
+        server->disconnect(connId);
+        return;
+    }
+
+    // Advertising stops on every connection; keep it up while slots are free
+    if (connected < MAX_CLIENTS) {
+        BLEDevice::startAdvertising();
+    }
+    EventLoop::signal(EventLoop::EVENT_CONNECTION);
+}
+
+void BLESerial::onClientDisconnected(uint16_t connId) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].connected && clients[i].connId == connId) {
+            clients[i].connected = false;
+        }
+    }
+    advertiseAfter = millis() + READVERTISE_DELAY_MS;
+    advertisingPending = true;
+    EventLoop::signal(EventLoop::EVENT_CONNECTION);
+}
+
+bool BLESerial::notify(BLECharacteristic* characteristic, uint16_t connId, const uint8_t* data, size_t length) {
+    // BLECharacteristic::notify() goes to every peer; this reaches just one
+    return esp_ble_gatts_send_indicate(server->getGattsIf(), connId, characteristic->getHandle(),
+                                       length, const_cast<uint8_t*>(data), false) == ESP_OK;
+}
+
 void BLESerial::write(const char* data) {
-    if (deviceConnected && txCharacteristic) {
-        txCharacteristic->setValue(data);
-        txCharacteristic->notify();
-        Serial.print("[BLE] TX notify sent: \"");
-        Serial.print(data);
-        Serial.println("\"");
-    } else if (!deviceConnected) {
-        Serial.println("[BLE] Warning: Attempted to write but no client connected");
+    if (!isConnected() || !txCharacteristic) {
+        return;
     }
+
+    write(reinterpret_cast<uint8_t*>(const_cast<char*>(data)), strlen(data));
 }
 
 void BLESerial::write(uint8_t* data, size_t length) {
-    if (deviceConnected && txCharacteristic) {
-        txCharacteristic->setValue(data, length);
-        txCharacteristic->notify();
+    if (!txCharacteristic) {
+        return;
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].connected) {
+            notify(txCharacteristic, clients[i].connId, data, length);
+        }
+    }
+}
+
+void BLESerial::write(uint16_t clientId, const uint8_t* data, size_t length) {
+    if (txCharacteristic) {
+        notify(txCharacteristic, clientId, data, length);
     }
 }
 
 bool BLESerial::isConnected() {
-    return deviceConnected;
+    return getClientCount() > 0;
+}
+
+int BLESerial::getClientCount() {
+    int count = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        count += clients[i].connected ? 1 : 0;
+    }
+    return count;
 }
 
 void BLESerial::handleConnection() {
-    if (!deviceConnected && oldDeviceConnected) {
-        Serial.println("[BLE] Restarting advertising after disconnect");
-        delay(500);
-        server->startAdvertising();
-        oldDeviceConnected = deviceConnected;
+    // Connection changes are reported here so the client callback always
+    // runs on the loop task, never in the BLE stack's
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        ClientSlot& slot = clients[i];
+        bool connected = slot.connected;
+        uint8_t generation = slot.generation;
+
+        if (slot.announced && (!connected || generation != slot.announcedGeneration)) {
+            slot.announced = false;
+            if (clientCallback) {
+                clientCallback(slot.announcedConnId, false);
+            }
+        }
+        if (connected && !slot.announced) {
+            slot.announced = true;
+            slot.announcedGeneration = generation;
+            slot.announcedConnId = slot.connId;
+            Serial.printf("[BLE] Client %u ready\n", slot.announcedConnId);
+            if (clientCallback) {
+                clientCallback(slot.announcedConnId, true);
+            }
+        }
     }
-    
-    if (deviceConnected && !oldDeviceConnected) {
-        Serial.println("[BLE] Connection state changed to connected");
-        oldDeviceConnected = deviceConnected;
+
+    // Give the stack a moment after a disconnect before advertising again
+    if (advertisingPending && (long)(millis() - advertiseAfter) >= 0) {
+        advertisingPending = false;
+        if (getClientCount() < MAX_CLIENTS) {
+            Serial.println("[BLE] Restarting advertising after disconnect");
+            server->startAdvertising();
+        }
     }
 }
 
+bool BLESerial::getDeadline(unsigned long& deadline) {
+    deadline = advertiseAfter;
+    return advertisingPending;
+}
+
 void BLESerial::setConfigCallback(ConfigCallback callback) {
     configCallback = callback;
 }
 
+void BLESerial::setClientCallback(ClientCallback callback) {
+    clientCallback = callback;
+}
+
 void BLESerial::writeStatus(const String& status) {
-    if (deviceConnected && statusCharacteristic) {
-        statusCharacteristic->setValue(status.c_str());
-        statusCharacteristic->notify();
-        Serial.print("[BLE] Status notify sent: \"");
-        Serial.print(status);
-        Serial.println("\"");
-    } else if (!deviceConnected) {
-        Serial.println("[BLE] Warning: Attempted to send status but no client connected");
-    }
-}
\ No newline at end of file
+    writeStatus(reinterpret_cast<const uint8_t*>(status.c_str()), status.length());
+}
+
+void BLESerial::writeStatus(const uint8_t* data, size_t length) {
+    if (!isConnected() || !statusCharacteristic) {
+        return;
+    }
+
+    // Readable by clients that poll instead of subscribing
+    statusCharacteristic->setValue(const_cast<uint8_t*>(data), length);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].connected) {
+            sendStatus(clients[i].connId, data, length);
+        }
+    }
+}
+
+void BLESerial::writeStatus(uint16_t clientId, const uint8_t* data, size_t length) {
+    if (!statusCharacteristic) {
+        return;
+    }
+
+    sendStatus(clientId, data, length);
+}
+
+int BLESerial::sendStatus(uint16_t connId, const uint8_t* data, size_t length) {
+    // Notifications are capped at the negotiated ATT payload, so split long
+    // responses; text is broken after a newline where possible
+    size_t payloadSize = getNotifyPayloadSize(connId);
+    bool binary = length > 0 && data[0] >= 0x80;
+    size_t offset = 0;
+    int chunks = 0;
+    while (offset < length) {
+        size_t chunk = min(payloadSize, length - offset);
+        if (!binary && offset + chunk < length) {
+            for (size_t i = chunk; i > 1; i--) {
+                if (data[offset + i - 1] == '\n') {
+                    chunk = i;
+                    break;
+                }
+            }
+        }
+        
+        notify(statusCharacteristic, connId, data + offset, chunk);
+        offset += chunk;
+        chunks++;
+    }
+    return chunks;
+}
+
+size_t BLESerial::getNotifyPayloadSize() {
+    size_t smallest = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].connected) {
+            size_t size = getNotifyPayloadSize(clients[i].connId);
+            smallest = smallest == 0 || size < smallest ? size : smallest;
+        }
+    }
+    return smallest ? smallest : 20;
+}
+
+size_t BLESerial::getNotifyPayloadSize(uint16_t clientId) {
+    // 3 bytes of every ATT PDU are opcode and handle
+    uint16_t mtu = server->getPeerMTU(clientId);
+    return mtu > 23 ? mtu - 3 : 20;
+}
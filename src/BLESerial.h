@@ -6,12 +6,27 @@
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h>
+#include "EventLoop.h"
 #include <functional>
 
-typedef std::function<void(const String&)> ConfigCallback;
+typedef std::function<void(uint16_t clientId, const uint8_t* data, size_t length)> ConfigCallback;
+typedef std::function<void(uint16_t clientId, bool connected)> ClientCallback;
 
 class BLESerial {
+public:
+    static const int MAX_CLIENTS = 3;
+
 private:
+    // Written by the BLE task, reported to the client callback from loop()
+    struct ClientSlot {
+        volatile bool connected;
+        volatile uint8_t generation;  // Bumped on every connect
+        volatile uint16_t connId;
+        bool announced;
+        uint8_t announcedGeneration;
+        uint16_t announcedConnId;
+    };
+
     BLEServer* server;
     BLEService* serialService;
     BLEService* configService;
@@ -19,34 +34,50 @@ private:
     BLECharacteristic* rxCharacteristic;
     BLECharacteristic* configCharacteristic;
     BLECharacteristic* statusCharacteristic;
-    bool deviceConnected;
-    bool oldDeviceConnected;
+    ClientSlot clients[MAX_CLIENTS];
+    volatile bool advertisingPending;
+    volatile unsigned long advertiseAfter;
     ConfigCallback configCallback;
-    
+    ClientCallback clientCallback;
+
     static const char* SERIAL_SERVICE_UUID;
     static const char* CONFIG_SERVICE_UUID;
     static const char* CHARACTERISTIC_UUID_RX;
     static const char* CHARACTERISTIC_UUID_TX;
     static const char* CHARACTERISTIC_UUID_CONFIG;
     static const char* CHARACTERISTIC_UUID_STATUS;
-    
+    static const uint16_t PREFERRED_MTU = 185;
+    static const unsigned long READVERTISE_DELAY_MS = 500;
+
     class ServerCallbacks;
     class CharacteristicCallbacks;
-    
+
 public:
     BLESerial();
     bool begin(const char* deviceName);
-    void write(const char* data);
-    void write(uint8_t* data, size_t length);
+    void write(const char* data);                 // Every client
+    void write(uint8_t* data, size_t length);     // Every client
+    void write(uint16_t clientId, const uint8_t* data, size_t length);
     bool isConnected();
-    void handleConnection();
+    int getClientCount();
+    void handleConnection();                      // Never blocks
+    bool getDeadline(unsigned long& deadline);    // When handleConnection() next has timed work
     void setConfigCallback(ConfigCallback callback);
-    void writeStatus(const String& status);
-    
+    void setClientCallback(ClientCallback callback);
+    void writeStatus(const String& status);       // Every client
+    void writeStatus(const uint8_t* data, size_t length);
+    void writeStatus(uint16_t clientId, const uint8_t* data, size_t length);
+    size_t getNotifyPayloadSize();                // Smallest across clients
+    size_t getNotifyPayloadSize(uint16_t clientId);
+
 private:
     void setupSerialService();
     void setupConfigService();
     void startAdvertising();
+    void onClientConnected(uint16_t connId);
+    void onClientDisconnected(uint16_t connId);
+    bool notify(BLECharacteristic* characteristic, uint16_t connId, const uint8_t* data, size_t length);
+    int sendStatus(uint16_t connId, const uint8_t* data, size_t length);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,253 @@
+#include "BinaryFrame.h"
+#include <string.h>
+
+static void writeU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static void writeU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+static uint16_t readU16(const uint8_t* data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t readU32(const uint8_t* data) {
+    return (uint32_t)data[0] |
+           ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) |
+           ((uint32_t)data[3] << 24);
+}
+
+// CRC-16/CCITT-FALSE
+uint16_t BinaryFrame::crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+size_t BinaryFrame::cobsEncode(const uint8_t* input, size_t length, uint8_t* output) {
+    size_t codeIndex = 0;
+    size_t outIndex = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++) {
+        if (input[i] == 0) {
+            output[codeIndex] = code;
+            codeIndex = outIndex++;
+            code = 1;
+            continue;
+        }
+
+        output[outIndex++] = input[i];
+        code++;
+        if (code == 0xFF) {
+            output[codeIndex] = code;
+            codeIndex = outIndex++;
+            code = 1;
+        }
+    }
+
+    output[codeIndex] = code;
+    return outIndex;
+}
+
+size_t BinaryFrame::cobsDecode(const uint8_t* input, size_t length, uint8_t* output) {
+    size_t inIndex = 0;
+    size_t outIndex = 0;
+
+    while (inIndex < length) {
+        uint8_t code = input[inIndex++];
+        if (code == 0 || inIndex + code - 1 > length) {
+            return 0;
+        }
+
+        for (uint8_t i = 1; i < code; i++) {
+            output[outIndex++] = input[inIndex++];
+        }
+        if (code != 0xFF && inIndex < length) {
+            output[outIndex++] = 0;
+        }
+    }
+
+    return outIndex;
+}
+
+bool BinaryFrame::parseRecord(const uint8_t* record, size_t length, BinaryRecord& out) {
+    if (length < HEADER_SIZE + CRC_SIZE) {
+        return false;
+    }
+    if (crc16(record, length - CRC_SIZE) != readU16(record + length - CRC_SIZE)) {
+        return false;
+    }
+
+    size_t payloadLength = length - HEADER_SIZE - CRC_SIZE;
+    const uint8_t* payload = record + HEADER_SIZE;
+
+    out.type = record[0];
+    out.sequence = readU16(record + 1);
+    out.timestamp = readU32(record + 3);
+    out.busId = 0;
+    out.address = 0;
+    out.flags = 0;
+    out.dataLength = 0;
+    out.dropped = 0;
+
+    switch (out.type) {
+        case RECORD_TRANSACTION:
+            if (payloadLength < 3 || payload[2] > I2CDecoder::MAX_DATA_SIZE ||
+                payloadLength != 3u + payload[2]) {
+                return false;
+            }
+            out.address = payload[0];
+            out.flags = payload[1];
+            out.busId = (out.flags & RECORD_FLAG_BUS_MASK) >> RECORD_FLAG_BUS_SHIFT;
+            out.dataLength = payload[2];
+            memcpy(out.data, payload + 3, out.dataLength);
+            return true;
+        case RECORD_DROPPED:
+            if (payloadLength != 5) {
+                return false;
+            }
+            out.busId = payload[0];
+            out.dropped = readU32(payload + 1);
+            return true;
+        default:
+            return false;
+    }
+}
+
+BinaryFrameWriter::BinaryFrameWriter() : sequence(0) {
+}
+
+size_t BinaryFrameWriter::encodeTransaction(const I2CTransaction& transaction, uint8_t* frame) {
+    uint8_t record[BinaryFrame::MAX_RECORD_SIZE];
+    size_t length = writeHeader(RECORD_TRANSACTION, transaction.timestamp, record);
+
+    size_t dataLength = transaction.data ? transaction.dataLength : 0;
+    if (dataLength > I2CDecoder::MAX_DATA_SIZE) {
+        dataLength = I2CDecoder::MAX_DATA_SIZE;
+    }
+
+    record[length++] = transaction.address;
+    record[length++] = (transaction.isRead ? RECORD_FLAG_READ : 0) |
+                       (transaction.hasError ? RECORD_FLAG_ERROR : 0) |
+                       ((transaction.busId << RECORD_FLAG_BUS_SHIFT) & RECORD_FLAG_BUS_MASK);
+    record[length++] = dataLength;
+    if (dataLength > 0) {
+        memcpy(record + length, transaction.data, dataLength);
+    }
+    length += dataLength;
+
+    return finishFrame(record, length, frame);
+}
+
+size_t BinaryFrameWriter::encodeDropped(uint8_t busId, uint32_t count, uint32_t timestamp, uint8_t* frame) {
+    uint8_t record[BinaryFrame::MAX_RECORD_SIZE];
+    size_t length = writeHeader(RECORD_DROPPED, timestamp, record);
+    record[length++] = busId;
+    writeU32(record + length, count);
+    length += 4;
+
+    return finishFrame(record, length, frame);
+}
+
+size_t BinaryFrameWriter::writeHeader(uint8_t type, uint32_t timestamp, uint8_t* record) {
+    record[0] = type;
+    writeU16(record + 1, sequence++);
+    writeU32(record + 3, timestamp);
+    return BinaryFrame::HEADER_SIZE;
+}
+
+size_t BinaryFrameWriter::finishFrame(uint8_t* record, size_t length, uint8_t* frame) {
+    writeU16(record + length, BinaryFrame::crc16(record, length));
+    length += BinaryFrame::CRC_SIZE;
+
+    // Leading delimiter resynchronises the host after interleaved text
+    frame[0] = 0;
+    size_t frameLength = 1 + BinaryFrame::cobsEncode(record, length, frame + 1);
+    frame[frameLength++] = 0;
+    return frameLength;
+}
+
+BinaryFrameReader::BinaryFrameReader() :
+    recordHandler(nullptr),
+    handlerContext(nullptr),
+    frameLength(0),
+    overflowed(false),
+    haveSequence(false),
+    expectedSequence(0),
+    recordCount(0),
+    badFrames(0),
+    lostRecords(0) {
+}
+
+void BinaryFrameReader::setRecordHandler(RecordHandler handler, void* context) {
+    recordHandler = handler;
+    handlerContext = context;
+}
+
+void BinaryFrameReader::feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] != 0) {
+            if (frameLength < sizeof(frame)) {
+                frame[frameLength++] = data[i];
+            } else {
+                overflowed = true;
+            }
+            continue;
+        }
+
+        if (overflowed) {
+            badFrames++;
+        } else if (frameLength > 0) {
+            processFrame();
+        }
+        frameLength = 0;
+        overflowed = false;
+    }
+}
+
+void BinaryFrameReader::processFrame() {
+    uint8_t record[BinaryFrame::MAX_FRAME_SIZE];
+    size_t length = BinaryFrame::cobsDecode(frame, frameLength, record);
+
+    BinaryRecord parsed;
+    if (length == 0 || !BinaryFrame::parseRecord(record, length, parsed)) {
+        badFrames++;
+        return;
+    }
+
+    if (haveSequence && parsed.sequence != expectedSequence) {
+        lostRecords += (uint16_t)(parsed.sequence - expectedSequence);
+    }
+    haveSequence = true;
+    expectedSequence = parsed.sequence + 1;
+    recordCount++;
+
+    if (recordHandler) {
+        recordHandler(handlerContext, parsed);
+    }
+}
+
+unsigned long BinaryFrameReader::getRecordCount() const {
+    return recordCount;
+}
+
+unsigned long BinaryFrameReader::getBadFrameCount() const {
+    return badFrames;
+}
+
+unsigned long BinaryFrameReader::getLostRecordCount() const {
+    return lostRecords;
+}
@@ -0,0 +1,99 @@
+#ifndef BINARY_FRAME_H
+#define BINARY_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I2CDecoder.h"
+
+// Binary transaction records for high-rate capture over USB CDC.
+//
+// Record:  type | sequence (u16 LE) | timestamp us (u32 LE) | payload | CRC-16 (u16 LE)
+//   RECORD_TRANSACTION payload: address | flags | length | data[length]
+//   RECORD_DROPPED payload:     bus | dropped transaction count (u32 LE)
+// Bits 4-5 of the transaction flags hold the bus ID.
+//
+// Each record is COBS-encoded and framed by a 0x00 delimiter on both sides,
+// so text logging interleaved on the same port is discarded by the CRC.
+
+enum BinaryRecordType {
+    RECORD_TRANSACTION = 0x01,
+    RECORD_DROPPED = 0x02
+};
+
+enum BinaryRecordFlags {
+    RECORD_FLAG_READ = 0x01,
+    RECORD_FLAG_ERROR = 0x02,
+    RECORD_FLAG_BUS_SHIFT = 4,
+    RECORD_FLAG_BUS_MASK = 0x30
+};
+
+struct BinaryRecord {
+    uint8_t type;
+    uint16_t sequence;
+    uint32_t timestamp;
+    uint8_t busId;
+    uint8_t address;
+    uint8_t flags;
+    uint8_t dataLength;
+    uint8_t data[I2CDecoder::MAX_DATA_SIZE];
+    uint32_t dropped;
+};
+
+class BinaryFrame {
+public:
+    static const size_t HEADER_SIZE = 7;
+    static const size_t CRC_SIZE = 2;
+    static const size_t MAX_RECORD_SIZE = HEADER_SIZE + 3 + I2CDecoder::MAX_DATA_SIZE + CRC_SIZE;
+    static const size_t MAX_FRAME_SIZE = MAX_RECORD_SIZE + MAX_RECORD_SIZE / 254 + 3;
+
+    static uint16_t crc16(const uint8_t* data, size_t length);
+    static size_t cobsEncode(const uint8_t* input, size_t length, uint8_t* output);
+    static size_t cobsDecode(const uint8_t* input, size_t length, uint8_t* output);  // 0 on error
+    static bool parseRecord(const uint8_t* record, size_t length, BinaryRecord& out);
+};
+
+class BinaryFrameWriter {
+private:
+    uint16_t sequence;
+
+public:
+    BinaryFrameWriter();
+    size_t encodeTransaction(const I2CTransaction& transaction, uint8_t* frame);
+    size_t encodeDropped(uint8_t busId, uint32_t count, uint32_t timestamp, uint8_t* frame);
+
+private:
+    size_t writeHeader(uint8_t type, uint32_t timestamp, uint8_t* record);
+    size_t finishFrame(uint8_t* record, size_t length, uint8_t* frame);
+};
+
+class BinaryFrameReader {
+public:
+    typedef void (*RecordHandler)(void* context, const BinaryRecord& record);
+
+private:
+    RecordHandler recordHandler;
+    void* handlerContext;
+
+    uint8_t frame[BinaryFrame::MAX_FRAME_SIZE];
+    size_t frameLength;
+    bool overflowed;
+    bool haveSequence;
+    uint16_t expectedSequence;
+
+    unsigned long recordCount;
+    unsigned long badFrames;
+    unsigned long lostRecords;
+
+public:
+    BinaryFrameReader();
+    void setRecordHandler(RecordHandler handler, void* context);
+    void feed(const uint8_t* data, size_t length);
+    unsigned long getRecordCount() const;
+    unsigned long getBadFrameCount() const;
+    unsigned long getLostRecordCount() const;
+
+private:
+    void processFrame();
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "ClientSession.h"
+
+ClientSessions::ClientSessions() {
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        resetSession(sessions[i], 0);
+        sessions[i].active = false;
+    }
+}
+
+void ClientSessions::resetSession(ClientSession& session, uint16_t clientId) {
+    session.active = true;
+    session.clientId = clientId;
+    session.filter.clearRanges();
+    session.selectedBus = 0;
+    session.hasFormat = false;
+    session.format = Hex;
+    session.latencyStamps = false;
+    session.compression = false;
+    session.compressionActive = false;
+    session.compressedWriter.reset();
+    session.blockStarted = 0;
+    session.compressedDropped = 0;
+}
+
+ClientSession* ClientSessions::open(uint16_t clientId) {
+    ClientSession* session = find(clientId);
+    for (int i = 0; !session && i < MAX_SESSIONS; i++) {
+        if (!sessions[i].active) {
+            session = &sessions[i];
+        }
+    }
+
+    // A reconnect on a reused connection ID starts from a clean view
+    if (session) {
+        resetSession(*session, clientId);
+    }
+    return session;
+}
+
+void ClientSessions::close(uint16_t clientId) {
+    ClientSession* session = find(clientId);
+    if (session) {
+        session->active = false;
+    }
+}
+
+ClientSession* ClientSessions::find(uint16_t clientId) {
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        if (sessions[i].active && sessions[i].clientId == clientId) {
+            return &sessions[i];
+        }
+    }
+    return nullptr;
+}
+
+ClientSession& ClientSessions::get(int index) {
+    return sessions[index];
+}
+
+bool ClientSessions::isActive(int index) {
+    return index >= 0 && index < MAX_SESSIONS && sessions[index].active;
+}
+
+int ClientSessions::getActiveCount() {
+    int count = 0;
+    for (int i = 0; i < MAX_SESSIONS; i++) {
+        count += sessions[i].active ? 1 : 0;
+    }
+    return count;
+}
+
+bool ClientSessions::admits(ClientSession& session, const I2CTransaction& transaction) {
+    if (session.filter.getRangeCount() == 0) {
+        return true;
+    }
+    return session.filter.admit(transaction.address, transaction.timestamp);
+}
+
+I2CFormatterType ClientSessions::formatFor(const ClientSession& session, const OutputSettings& output) {
+    return session.hasFormat ? session.format : output.dataFormat;
+}
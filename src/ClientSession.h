@@ -0,0 +1,51 @@
+#ifndef CLIENT_SESSION_H
+#define CLIENT_SESSION_H
+
+#include <stdint.h>
+#include "AddressFilter.h"
+#include "CompressedStream.h"
+#include "I2CDecoder.h"
+#include "I2CFormatter.h"
+
+// What one BLE client sees of the captured stream. The device-wide filters
+// decide what is captured at all; a client's own ranges and sampling policies
+// narrow that further for its connection only. Sessions are not persisted.
+struct ClientSession {
+    bool active;
+    uint16_t clientId;         // BLE connection ID
+    AddressFilter filter;      // No ranges: everything the device captures
+    int selectedBus;           // BUS selection for this client's commands
+    bool hasFormat;            // Otherwise the device FORMAT applies
+    I2CFormatterType format;
+    bool latencyStamps;
+    bool compression;
+    bool compressionActive;    // Dictionary reset sent since COMPRESS ON
+    CompressedBlockWriter compressedWriter;
+    unsigned long blockStarted;  // millis() of the first record in the pending block
+    uint32_t compressedDropped;  // Records too large for an empty block, not yet reported
+};
+
+class ClientSessions {
+public:
+    static const int MAX_SESSIONS = 3;
+
+private:
+    ClientSession sessions[MAX_SESSIONS];
+
+public:
+    ClientSessions();
+    ClientSession* open(uint16_t clientId);
+    void close(uint16_t clientId);
+    ClientSession* find(uint16_t clientId);
+    ClientSession& get(int index);  // Check isActive() first
+    bool isActive(int index);
+    int getActiveCount();
+
+    static bool admits(ClientSession& session, const I2CTransaction& transaction);
+    static I2CFormatterType formatFor(const ClientSession& session, const OutputSettings& output);
+
+private:
+    static void resetSession(ClientSession& session, uint16_t clientId);
+};
+
+#endif
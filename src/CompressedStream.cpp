@@ -0,0 +1,416 @@
+#include "CompressedStream.h"
+#include <string.h>
+
+static uint32_t zigzagEncode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t zigzagDecode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+CompressedBlockWriter::CompressedBlockWriter() :
+    length(0),
+    blockLimit(MAX_BLOCK_SIZE),
+    recordCount(0),
+    sequence(0),
+    blocksSinceReset(0),
+    resetPending(true),
+    lastTimestamp(0),
+    useCounter(0),
+    runSlot(0),
+    runCount(0),
+    runBytes(0) {
+    memset(buffer, 0, MAX_BLOCK_SIZE);
+    memset(slots, 0, sizeof(slots));
+}
+
+void CompressedBlockWriter::reset() {
+    length = 0;
+    recordCount = 0;
+    runCount = 0;
+    runBytes = 0;
+    resetPending = true;
+}
+
+void CompressedBlockWriter::setBlockLimit(size_t limit) {
+    if (limit < MIN_BLOCK_SIZE) {
+        limit = MIN_BLOCK_SIZE;
+    } else if (limit > MAX_BLOCK_SIZE) {
+        limit = MAX_BLOCK_SIZE;
+    }
+    blockLimit = limit;
+}
+
+void CompressedBlockWriter::beginBlock() {
+    buffer[0] = BLOCK_MARKER;
+    buffer[1] = sequence++;
+    length = 2;
+
+    // Periodic resets bound how long a reader stays lost after a bad block
+    if (resetPending || blocksSinceReset >= RESET_INTERVAL) {
+        buffer[length++] = tag(COMPRESSED_RESET, 0, false);
+        memset(slots, 0, sizeof(slots));
+        lastTimestamp = 0;
+        blocksSinceReset = 0;
+        resetPending = false;
+    }
+    blocksSinceReset++;
+}
+
+bool CompressedBlockWriter::append(const I2CTransaction& transaction) {
+    if (length == 0) {
+        beginBlock();
+    }
+
+    uint32_t delta = zigzagEncode((int32_t)((uint32_t)transaction.timestamp - lastTimestamp));
+    size_t deltaSize = varintSize(delta);
+    int slot = findSlot(transaction);
+
+    if (slot >= 0 && isRepeat(slot, transaction)) {
+        if (runCount > 0 && runSlot == slot && runCount < MAX_RUN) {
+            if (length + runBytes + deltaSize > blockLimit) {
+                return false;
+            }
+            runDeltas[runCount++] = delta;
+            runBytes += deltaSize;
+        } else {
+            closeRun();
+            size_t needed = 2 + deltaSize;  // Tag and a one-byte count
+            if (length + needed > blockLimit) {
+                return false;
+            }
+            runSlot = slot;
+            runCount = 1;
+            runDeltas[0] = delta;
+            runBytes = needed;
+        }
+        slots[slot].lastUse = ++useCounter;
+    } else {
+        closeRun();
+        size_t dataLength = transaction.dataLength;
+        if (slot >= 0) {
+            if (length + 2 + deltaSize + dataLength - 1 > blockLimit) {
+                return false;
+            }
+            buffer[length++] = tag(COMPRESSED_KEYED, slot, transaction.hasError);
+            length += writeVarint(buffer + length, delta);
+            buffer[length++] = dataLength;
+            memcpy(buffer + length, transaction.data + 1, dataLength - 1);
+            length += dataLength - 1;
+        } else {
+            if (length + 4 + deltaSize + dataLength > blockLimit) {
+                return false;
+            }
+            slot = allocateSlot();
+            buffer[length++] = tag(COMPRESSED_LITERAL, slot, transaction.hasError);
+            length += writeVarint(buffer + length, delta);
+            buffer[length++] = (transaction.address << 1) | (transaction.isRead ? 1 : 0);
+            buffer[length++] = transaction.busId;
+            buffer[length++] = dataLength;
+            memcpy(buffer + length, transaction.data, dataLength);
+            length += dataLength;
+        }
+        storeSlot(slot, transaction);
+    }
+
+    lastTimestamp = transaction.timestamp;
+    recordCount++;
+    return true;
+}
+
+bool CompressedBlockWriter::isEmpty() const {
+    return recordCount == 0;
+}
+
+size_t CompressedBlockWriter::finish() {
+    closeRun();
+    size_t size = length;
+    length = 0;
+    recordCount = 0;
+    return size;
+}
+
+const uint8_t* CompressedBlockWriter::data() const {
+    return buffer;
+}
+
+void CompressedBlockWriter::closeRun() {
+    if (runCount == 0) {
+        return;
+    }
+
+    buffer[length++] = tag(COMPRESSED_REPEAT, runSlot, slots[runSlot].hasError);
+    buffer[length++] = runCount;
+    for (uint8_t i = 0; i < runCount; i++) {
+        length += writeVarint(buffer + length, runDeltas[i]);
+    }
+    runCount = 0;
+    runBytes = 0;
+}
+
+int CompressedBlockWriter::findSlot(const I2CTransaction& transaction) const {
+    if (transaction.dataLength == 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        const CompressedSlot& slot = slots[i];
+        if (slot.used && slot.length > 0 &&
+            slot.busId == transaction.busId &&
+            slot.address == transaction.address &&
+            slot.isRead == transaction.isRead &&
+            slot.payload[0] == transaction.data[0]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int CompressedBlockWriter::allocateSlot() const {
+    int oldest = 0;
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        if (!slots[i].used) {
+            return i;
+        }
+        if (slots[i].lastUse < slots[oldest].lastUse) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+void CompressedBlockWriter::storeSlot(int slot, const I2CTransaction& transaction) {
+    CompressedSlot& entry = slots[slot];
+    entry.used = true;
+    entry.busId = transaction.busId;
+    entry.address = transaction.address;
+    entry.isRead = transaction.isRead;
+    entry.hasError = transaction.hasError;
+    entry.length = transaction.dataLength;
+    memcpy(entry.payload, transaction.data, transaction.dataLength);
+    entry.lastUse = ++useCounter;
+}
+
+bool CompressedBlockWriter::isRepeat(int slot, const I2CTransaction& transaction) const {
+    const CompressedSlot& entry = slots[slot];
+    return entry.length == transaction.dataLength &&
+           entry.hasError == transaction.hasError &&
+           memcmp(entry.payload, transaction.data, transaction.dataLength) == 0;
+}
+
+uint8_t CompressedBlockWriter::tag(CompressedRecordKind kind, int slot, bool hasError) const {
+    return (kind << 6) | ((slot & 0x0F) << 2) | (hasError ? 1 : 0);
+}
+
+size_t CompressedBlockWriter::varintSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+size_t CompressedBlockWriter::writeVarint(uint8_t* out, uint32_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[size++] = value;
+    return size;
+}
+
+CompressedStreamReader::CompressedStreamReader() :
+    transactionHandler(nullptr),
+    handlerContext(nullptr),
+    synced(false),
+    haveSequence(false),
+    expectedSequence(0),
+    lastTimestamp(0),
+    blockCount(0),
+    transactionCount(0),
+    corruptBlocks(0),
+    lostBlocks(0),
+    unresolvedRecords(0) {
+    memset(slots, 0, sizeof(slots));
+}
+
+void CompressedStreamReader::setTransactionHandler(TransactionHandler handler, void* context) {
+    transactionHandler = handler;
+    handlerContext = context;
+}
+
+void CompressedStreamReader::feedBlock(const uint8_t* block, size_t length) {
+    if (length < 2 || block[0] != CompressedBlockWriter::BLOCK_MARKER) {
+        corruptBlocks++;
+        synced = false;
+        return;
+    }
+
+    if (haveSequence && block[1] != expectedSequence) {
+        lostBlocks += (uint8_t)(block[1] - expectedSequence);
+        synced = false;
+    }
+    haveSequence = true;
+    expectedSequence = block[1] + 1;
+
+    blockCount++;
+    size_t offset = 2;
+    while (offset < length) {
+        if (!parseRecord(block, length, offset)) {
+            // The dictionary may now differ from the writer's until the next RESET
+            corruptBlocks++;
+            synced = false;
+            return;
+        }
+    }
+}
+
+bool CompressedStreamReader::parseRecord(const uint8_t* data, size_t length, size_t& offset) {
+    uint8_t tag = data[offset++];
+    uint8_t kind = tag >> 6;
+    int slot = (tag >> 2) & 0x0F;
+    bool hasError = tag & 0x01;
+    uint32_t delta;
+
+    switch (kind) {
+        case COMPRESSED_RESET:
+            memset(slots, 0, sizeof(slots));
+            lastTimestamp = 0;
+            synced = true;
+            return true;
+
+        case COMPRESSED_LITERAL: {
+            if (!readVarint(data, length, offset, delta) || offset + 3 > length) {
+                return false;
+            }
+            uint8_t address = data[offset];
+            uint8_t busId = data[offset + 1];
+            uint8_t dataLength = data[offset + 2];
+            offset += 3;
+            if (dataLength > I2CDecoder::MAX_DATA_SIZE || offset + dataLength > length) {
+                return false;
+            }
+
+            if (synced) {
+                CompressedSlot& entry = slots[slot];
+                entry.used = true;
+                entry.address = address >> 1;
+                entry.isRead = address & 0x01;
+                entry.busId = busId;
+                entry.hasError = hasError;
+                entry.length = dataLength;
+                memcpy(entry.payload, data + offset, dataLength);
+                lastTimestamp += zigzagDecode(delta);
+                emit(slot, lastTimestamp);
+            } else {
+                unresolvedRecords++;
+            }
+            offset += dataLength;
+            return true;
+        }
+
+        case COMPRESSED_KEYED: {
+            if (!readVarint(data, length, offset, delta) || offset + 1 > length) {
+                return false;
+            }
+            uint8_t dataLength = data[offset++];
+            if (dataLength == 0 || dataLength > I2CDecoder::MAX_DATA_SIZE || offset + dataLength - 1 > length) {
+                return false;
+            }
+
+            CompressedSlot& entry = slots[slot];
+            if (synced) {
+                lastTimestamp += zigzagDecode(delta);
+            }
+            if (synced && entry.used && entry.length > 0) {
+                entry.hasError = hasError;
+                entry.length = dataLength;
+                memcpy(entry.payload + 1, data + offset, dataLength - 1);
+                emit(slot, lastTimestamp);
+            } else {
+                unresolvedRecords++;
+            }
+            offset += dataLength - 1;
+            return true;
+        }
+
+        case COMPRESSED_REPEAT:
+        default: {
+            if (offset + 1 > length) {
+                return false;
+            }
+            uint8_t count = data[offset++];
+            for (uint8_t i = 0; i < count; i++) {
+                if (!readVarint(data, length, offset, delta)) {
+                    return false;
+                }
+                if (synced) {
+                    lastTimestamp += zigzagDecode(delta);
+                }
+                if (synced && slots[slot].used) {
+                    emit(slot, lastTimestamp);
+                } else {
+                    unresolvedRecords++;
+                }
+            }
+            return true;
+        }
+    }
+}
+
+void CompressedStreamReader::emit(int slot, uint32_t timestamp) {
+    const CompressedSlot& entry = slots[slot];
+    transactionCount++;
+    if (!transactionHandler) {
+        return;
+    }
+
+    I2CTransaction transaction;
+    transaction.address = entry.address;
+    transaction.isRead = entry.isRead;
+    transaction.data = const_cast<uint8_t*>(entry.payload);
+    transaction.dataLength = entry.length;
+    transaction.timestamp = timestamp;
+    transaction.endTimestamp = timestamp;  // Not carried in the stream
+    transaction.hasError = entry.hasError;
+    transaction.busId = entry.busId;
+    transactionHandler(handlerContext, transaction);
+}
+
+bool CompressedStreamReader::readVarint(const uint8_t* data, size_t length, size_t& offset, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset >= length) {
+            return false;
+        }
+        uint8_t byte = data[offset++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned long CompressedStreamReader::getBlockCount() const {
+    return blockCount;
+}
+
+unsigned long CompressedStreamReader::getTransactionCount() const {
+    return transactionCount;
+}
+
+unsigned long CompressedStreamReader::getCorruptBlockCount() const {
+    return corruptBlocks;
+}
+
+unsigned long CompressedStreamReader::getLostBlockCount() const {
+    return lostBlocks;
+}
+
+unsigned long CompressedStreamReader::getUnresolvedRecordCount() const {
+    return unresolvedRecords;
+}
@@ -0,0 +1,126 @@
+#ifndef COMPRESSED_STREAM_H
+#define COMPRESSED_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I2CDecoder.h"
+
+// Compressed transaction stream for the BLE data characteristic. Each block
+// fits one notification; the dictionary carries over from block to block.
+//
+// Block: 0xC5 | sequence | records...
+// Record tag: kind (bits 6-7) | dictionary slot (bits 2-5) | error (bit 0)
+//   LITERAL: tag | ts delta | address << 1 | read | bus | length | data[length]
+//   KEYED:   tag | ts delta | length | data[1..length]     (data[0] from slot)
+//   REPEAT:  tag | count | ts delta[count]                  (slot's last payload)
+//   RESET:   tag                                           (clear dictionary)
+//
+// Timestamp deltas are zigzag LEB128 of the signed microsecond difference to
+// the previous record; the first record after RESET is relative to 0. A slot
+// is keyed by bus, address, direction and first data byte (usually the
+// register pointer) and remembers the last payload sent through it. A reader
+// that sees a sequence gap or a bad record drops records until the next RESET.
+
+enum CompressedRecordKind {
+    COMPRESSED_LITERAL = 0,
+    COMPRESSED_KEYED = 1,
+    COMPRESSED_REPEAT = 2,
+    COMPRESSED_RESET = 3
+};
+
+struct CompressedSlot {
+    bool used;
+    uint8_t busId;
+    uint8_t address;
+    bool isRead;
+    bool hasError;
+    uint8_t length;
+    uint8_t payload[I2CDecoder::MAX_DATA_SIZE];
+    uint32_t lastUse;
+};
+
+class CompressedBlockWriter {
+public:
+    static const uint8_t BLOCK_MARKER = 0xC5;
+    static const size_t MAX_BLOCK_SIZE = 244;
+    static const size_t MIN_BLOCK_SIZE = 20;   // Default ATT MTU payload; blocks must fit one notification
+    static const int SLOT_COUNT = 16;
+    static const uint8_t MAX_RUN = 16;
+    static const uint32_t RESET_INTERVAL = 64;  // Blocks between dictionary resets
+
+private:
+    uint8_t buffer[MAX_BLOCK_SIZE];
+    size_t length;
+    size_t blockLimit;
+    int recordCount;
+    uint8_t sequence;
+    uint32_t blocksSinceReset;
+    bool resetPending;
+    uint32_t lastTimestamp;
+    uint32_t useCounter;
+    CompressedSlot slots[SLOT_COUNT];
+
+    // Pending REPEAT record, written out when the run breaks or the block ends
+    int runSlot;
+    uint8_t runCount;
+    size_t runBytes;
+    uint32_t runDeltas[MAX_RUN];
+
+public:
+    CompressedBlockWriter();
+    void reset();                         // Next block starts with RESET
+    void setBlockLimit(size_t limit);     // Usually the notification payload size
+    bool append(const I2CTransaction& transaction);  // false once the block is full
+    bool isEmpty() const;
+    size_t finish();
+    const uint8_t* data() const;
+
+private:
+    void beginBlock();
+    void closeRun();
+    int findSlot(const I2CTransaction& transaction) const;
+    int allocateSlot() const;
+    void storeSlot(int slot, const I2CTransaction& transaction);
+    bool isRepeat(int slot, const I2CTransaction& transaction) const;
+    uint8_t tag(CompressedRecordKind kind, int slot, bool hasError) const;
+    static size_t varintSize(uint32_t value);
+    static size_t writeVarint(uint8_t* out, uint32_t value);
+};
+
+class CompressedStreamReader {
+public:
+    typedef void (*TransactionHandler)(void* context, const I2CTransaction& transaction);
+
+private:
+    TransactionHandler transactionHandler;
+    void* handlerContext;
+
+    CompressedSlot slots[CompressedBlockWriter::SLOT_COUNT];
+    bool synced;  // A RESET has been seen since start or the last lost block
+    bool haveSequence;
+    uint8_t expectedSequence;
+    uint32_t lastTimestamp;
+
+    unsigned long blockCount;
+    unsigned long transactionCount;
+    unsigned long corruptBlocks;
+    unsigned long lostBlocks;
+    unsigned long unresolvedRecords;
+
+public:
+    CompressedStreamReader();
+    void setTransactionHandler(TransactionHandler handler, void* context);
+    void feedBlock(const uint8_t* block, size_t length);  // One notification
+    unsigned long getBlockCount() const;
+    unsigned long getTransactionCount() const;
+    unsigned long getCorruptBlockCount() const;
+    unsigned long getLostBlockCount() const;
+    unsigned long getUnresolvedRecordCount() const;
+
+private:
+    bool parseRecord(const uint8_t* data, size_t length, size_t& offset);
+    void emit(int slot, uint32_t timestamp);
+    static bool readVarint(const uint8_t* data, size_t length, size_t& offset, uint32_t& value);
+};
+
+#endif
@@ -1,132 +1,943 @@
 #include "ConfigParser.h"
+#include <stdarg.h>
+#include <string.h>
 
-ConfigParser::CommandResult ConfigParser::parseCommand(const String& command, AddressFilter& filter, String& response) {
-    String cmd = command;
-    cmd.trim();
-    cmd.toUpperCase();
-    
-    if (cmd.startsWith("ADD ")) {
-        return parseAddressRange(cmd.substring(4), filter, response);
-    } else if (cmd == "LIST") {
-        return parseListRanges(filter, response);
-    } else if (cmd == "CLEAR") {
-        return parseClearRanges(filter, response);
-    } else if (cmd == "HELP") {
-        return parseHelp(response);
+// Indexed by ConfigKeyword
+static const char* const KEYWORD_NAMES[] = {
+    "", "-", "ON", "OFF", "CLEAR", "DUMP", "ALL", "RATE", "EVERY", "FIRST",
+    "DECODE", "RAW", "BLE", "TEXT", "BINARY", "HEX", "BIN", "DEC", "FAST", "NORMAL",
+    "ADD", "FORMAT", "WINDOW"
+};
+
+const ConfigParser::CommandEntry ConfigParser::COMMANDS[] = {
+    {"ADD", 0x01, 5, handleAdd,
+        "ADD 0x08-0x77  - Add address range\n"
+        "ADD 0x50       - Add single address\n"
+        "ADD 0x48 RATE 100   - Max 100 transactions/s\n"
+        "ADD 0x48 EVERY 10   - Forward 1 in 10 transactions\n"
+        "ADD 0x48 FIRST 5    - Forward first 5, then count\n"},
+    {"SAMPLE", 0x04, 3, handleSample, "SAMPLE 0 ALL   - Change sampling of range 0\n"},
+    {"LIST", 0x02, 0, handleList, "LIST           - List current ranges\n"},
+    {"CLEAR", 0x03, 0, handleClear, "CLEAR          - Clear all ranges\n"},
+    {"SHADOW", 0x05, 1, handleShadow,
+        "SHADOW ON/OFF  - Stream only changed registers\n"
+        "SHADOW DUMP    - List mirrored register values\n"
+        "SHADOW CLEAR   - Forget mirrored registers\n"},
+    {"OUTPUT", 0x06, 1, handleOutput,
+        "OUTPUT TEXT    - Text lines on USB serial\n"
+        "OUTPUT BINARY  - Framed binary records on USB serial\n"},
+    {"FORMAT", 0x07, 1, handleFormat, "FORMAT HEX/BIN/DEC - Data byte format\n"},
+    {"BOOT", 0x08, 1, handleBoot, "BOOT FAST/NORMAL   - Skip serial wait at boot\n"},
+    {"SAVE", 0x09, 0, handleSave, "SAVE           - Persist settings to flash\n"},
+    {"LOAD", 0x0A, 0, handleLoad, "LOAD           - Reload saved settings\n"},
+    {"RESET", 0x0B, 0, handleReset, "RESET          - Erase saved settings\n"},
+    {"BUS", 0x0C, 1, handleBus,
+        "BUS            - List buses and statistics\n"
+        "BUS 1          - Select bus for ADD/LIST/SHADOW/MODE\n"},
+    {"MODE", 0x0D, 2, handleMode,
+        "MODE           - Show capture mode\n"
+        "MODE DECODE    - Decode transactions on device\n"
+        "MODE RAW       - Stream raw edges over serial\n"
+        "MODE RAW BLE   - Stream raw edges over serial and BLE\n"},
+    {"LATENCY", 0x0F, 1, handleLatency, "LATENCY ON/OFF - Stamp this client's BLE lines with device timings\n"},
+    {"COMPRESS", 0x11, 1, handleCompress, "COMPRESS ON/OFF - Compressed binary blocks on this client's BLE data\n"},
+    {"CLIENT", 0x12, 6, handleClient,
+        "CLIENT         - Show this BLE client's view\n"
+        "CLIENT ADD 0x48 RATE 10 - Narrow this client to a range\n"
+        "CLIENT CLEAR   - Receive everything captured again\n"
+        "CLIENT FORMAT HEX/BIN/DEC - Data format for this client only\n"},
+    {"DISSECT", 0x14, 2, handleDissect,
+        "DISSECT        - List dissectors and bindings\n"
+        "DISSECT 0x48 TMP102 - Decode values for an address on this bus\n"
+        "DISSECT 0x48 OFF    - Back to raw bytes\n"
+        "DISSECT WINDOW 1000 - Min/max/mean per 1000 ms, 0 for every value\n"
+        "DISSECT CLEAR  - Remove all bindings\n"},
+    {"STATS", 0x13, 0, handleStats, "STATS          - Heap, stack and queue telemetry\n"},
+    {"SYNC", 0x10, 1, handleSync, "SYNC 123       - Clock sync, echoes 123 and device micros\n"},
+    {"HELP", 0x0E, 0, handleHelp, "HELP           - Show this help\n"},
+};
+
+const size_t ConfigParser::COMMAND_COUNT = sizeof(ConfigParser::COMMANDS) / sizeof(ConfigParser::COMMANDS[0]);
+
+ConfigResponse::ConfigResponse() {
+    clear();
+}
+
+void ConfigResponse::clear() {
+    used = 0;
+    truncated = false;
+    buffer[0] = '\0';
+}
+
+void ConfigResponse::append(const char* text) {
+    append(reinterpret_cast<const uint8_t*>(text), strlen(text));
+}
+
+void ConfigResponse::append(const uint8_t* bytes, size_t count) {
+    if (count > CAPACITY - used) {
+        count = CAPACITY - used;
+        truncated = true;
+    }
+    memcpy(buffer + used, bytes, count);
+    used += count;
+    buffer[used] = '\0';
+}
+
+void ConfigResponse::appendByte(uint8_t value) {
+    append(&value, 1);
+}
+
+void ConfigResponse::appendf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + used, CAPACITY - used + 1, format, args);
+    va_end(args);
+
+    if (written < 0) {
+        buffer[used] = '\0';
+    } else if ((size_t)written > CAPACITY - used) {
+        used = CAPACITY;
+        truncated = true;
     } else {
-        response = "ERROR: Unknown command. Send 'HELP' for usage.";
-        return INVALID_COMMAND;
+        used += written;
     }
 }
 
-ConfigParser::CommandResult ConfigParser::parseAddressRange(const String& params, AddressFilter& filter, String& response) {
-    String trimmed = params;
-    trimmed.trim();
-    
-    int dashIndex = trimmed.indexOf('-');
-    if (dashIndex == -1) {
-        // Single address
-        if (!isValidHex(trimmed)) {
-            response = "ERROR: Invalid hex address format. Use 0x08-0x77 format.";
-            return INVALID_PARAMETERS;
+void ConfigResponse::patchByte(size_t offset, uint8_t value) {
+    if (offset < used) {
+        buffer[offset] = value;
+    }
+}
+
+bool ConfigParser::isBinary(const uint8_t* data, size_t length) {
+    return length > 0 && data[0] == CONFIG_BINARY_MARKER;
+}
+
+ConfigParser::CommandResult ConfigParser::parseBatch(const uint8_t* data, size_t length, ConfigContext& context, ConfigResponse& response) {
+    CommandResult firstFailure = SUCCESS;
+
+    if (isBinary(data, length)) {
+        // [marker] { opcode | arg length | args }*
+        response.appendByte(CONFIG_BINARY_MARKER);
+        size_t offset = 1;
+        while (offset < length) {
+            uint8_t opcode = data[offset];
+            size_t argLength = offset + 1 < length ? data[offset + 1] : 0;
+            bool complete = offset + 2 + argLength <= length;
+
+            CommandResult result = parseBinaryCommand(opcode, complete ? data + offset + 2 : nullptr,
+                                                      argLength, context, response);
+            if (result != SUCCESS && firstFailure == SUCCESS) {
+                firstFailure = result;
+            }
+            if (!complete) {
+                break;
+            }
+            offset += 2 + argLength;
         }
-        
-        uint8_t addr = parseHexByte(trimmed);
-        if (!filter.addRange(addr, addr)) {
-            response = "ERROR: Could not add range. Check address validity or range limit.";
-            return OUT_OF_RANGE;
+        return firstFailure;
+    }
+
+    size_t start = 0;
+    bool first = true;
+    for (size_t i = 0; i <= length; i++) {
+        if (i < length && data[i] != '\n' && data[i] != '\r' && data[i] != ';') {
+            continue;
         }
-        
-        response = "Added address range: 0x" + String(addr, HEX) + "-0x" + String(addr, HEX);
-        return SUCCESS;
+
+        const char* segment = reinterpret_cast<const char*>(data + start);
+        size_t segmentLength = i - start;
+        start = i + 1;
+
+        size_t blank = 0;
+        while (blank < segmentLength && isspace((unsigned char)segment[blank])) {
+            blank++;
+        }
+        if (blank == segmentLength) {
+            continue;
+        }
+
+        if (!first) {
+            response.appendByte('\n');
+        }
+        first = false;
+
+        CommandResult result = parseCommand(segment, segmentLength, context, response);
+        if (result != SUCCESS && firstFailure == SUCCESS) {
+            firstFailure = result;
+        }
+    }
+
+    if (first) {
+        response.append("ERROR: Empty command. Send 'HELP' for usage.");
+        return INVALID_COMMAND;
+    }
+    return firstFailure;
+}
+
+ConfigParser::CommandResult ConfigParser::parseCommand(const char* command, size_t length, ConfigContext& context, ConfigResponse& response) {
+    if (length > MAX_COMMAND_LENGTH) {
+        response.append("ERROR: Command too long.");
+        return INVALID_PARAMETERS;
+    }
+
+    char line[MAX_COMMAND_LENGTH + 1];
+    for (size_t i = 0; i < length; i++) {
+        line[i] = toupper((unsigned char)command[i]);
+    }
+    line[length] = '\0';
+
+    const char* name;
+    ConfigArgs args;
+    if (!tokenize(line, name, args)) {
+        response.append("ERROR: Too many parameters.");
+        return INVALID_PARAMETERS;
+    }
+
+    const CommandEntry* entry = name ? findCommand(name) : nullptr;
+    if (!entry) {
+        response.append("ERROR: Unknown command. Send 'HELP' for usage.");
+        return INVALID_COMMAND;
+    }
+    return dispatch(entry, args, context, response);
+}
+
+ConfigParser::CommandResult ConfigParser::parseBinaryCommand(uint8_t opcode, const uint8_t* args, size_t length, ConfigContext& context, ConfigResponse& response) {
+    // Response record: opcode | status | message length u16 LE | message
+    size_t header = response.length();
+    response.appendByte(opcode);
+    response.appendByte(SUCCESS);
+    response.appendByte(0);
+    response.appendByte(0);
+
+    CommandResult result;
+    ConfigArgs decoded;
+    const CommandEntry* entry = findOpcode(opcode);
+    if (!args) {
+        response.append("ERROR: Truncated command.");
+        result = INVALID_PARAMETERS;
+    } else if (!entry) {
+        response.append("ERROR: Unknown command. Send 'HELP' for usage.");
+        result = INVALID_COMMAND;
+    } else if (!decodeBinaryArgs(args, length, decoded)) {
+        response.append("ERROR: Malformed parameters.");
+        result = INVALID_PARAMETERS;
     } else {
-        // Address range
-        String startStr = trimmed.substring(0, dashIndex);
-        String endStr = trimmed.substring(dashIndex + 1);
-        startStr.trim();
-        endStr.trim();
-        
-        if (!isValidHex(startStr) || !isValidHex(endStr)) {
-            response = "ERROR: Invalid hex format. Use 0x08-0x77 format.";
-            return INVALID_PARAMETERS;
+        result = dispatch(entry, decoded, context, response);
+    }
+
+    size_t messageLength = response.length() - header - 4;
+    response.patchByte(header + 1, result);
+    response.patchByte(header + 2, messageLength & 0xFF);
+    response.patchByte(header + 3, messageLength >> 8);
+    return result;
+}
+
+ConfigParser::CommandResult ConfigParser::dispatch(const CommandEntry* entry, const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (args.count > entry->maxArgs) {
+        response.appendf("ERROR: Too many parameters for %s.", entry->name);
+        return INVALID_PARAMETERS;
+    }
+    return entry->handler(args, context, response);
+}
+
+const ConfigParser::CommandEntry* ConfigParser::findCommand(const char* name) {
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        if (strcmp(COMMANDS[i].name, name) == 0) {
+            return &COMMANDS[i];
         }
-        
-        uint8_t startAddr = parseHexByte(startStr);
-        uint8_t endAddr = parseHexByte(endStr);
-        
-        if (!filter.addRange(startAddr, endAddr)) {
-            response = "ERROR: Could not add range. Check addresses are valid (0x08-0x77) and start <= end.";
-            return OUT_OF_RANGE;
+    }
+    return nullptr;
+}
+
+const ConfigParser::CommandEntry* ConfigParser::findOpcode(uint8_t opcode) {
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        if (COMMANDS[i].opcode == opcode) {
+            return &COMMANDS[i];
+        }
+    }
+    return nullptr;
+}
+
+bool ConfigParser::tokenize(char* line, const char*& name, ConfigArgs& args) {
+    name = nullptr;
+    args.count = 0;
+    args.binary = false;
+
+    // Splits in place on whitespace; '-' is both a separator and a token
+    char* cursor = line;
+    while (true) {
+        while (*cursor == ' ' || *cursor == '\t') {
+            cursor++;
+        }
+        if (*cursor == '\0') {
+            return true;
+        }
+
+        if (*cursor != '-') {
+            char* token = cursor;
+            while (*cursor != '\0' && *cursor != ' ' && *cursor != '\t' && *cursor != '-') {
+                cursor++;
+            }
+            char separator = *cursor;
+            *cursor = '\0';
+
+            if (!name) {
+                name = token;
+            } else if (!addTextArg(token, args)) {
+                return false;
+            }
+            if (separator != '-') {
+                if (separator != '\0') {
+                    cursor++;
+                }
+                continue;
+            }
+        }
+
+        cursor++;
+        if (!addTextArg(KEYWORD_NAMES[KEYWORD_DASH], args)) {
+            return false;
         }
-        
-        response = "Added address range: 0x" + String(startAddr, HEX) + "-0x" + String(endAddr, HEX);
-        return SUCCESS;
     }
 }
 
-ConfigParser::CommandResult ConfigParser::parseListRanges(AddressFilter& filter, String& response) {
-    response = "Active address ranges:\n";
+bool ConfigParser::addTextArg(const char* token, ConfigArgs& args) {
+    if (args.count >= ConfigArgs::MAX_ARGS) {
+        return false;
+    }
+
+    ConfigArg& arg = args.items[args.count++];
+    arg.text = token;
+    arg.keyword = KEYWORD_NONE;
+    arg.isNumber = false;
+    arg.number = 0;
+
+    for (size_t i = KEYWORD_DASH; i < sizeof(KEYWORD_NAMES) / sizeof(KEYWORD_NAMES[0]); i++) {
+        if (strcmp(token, KEYWORD_NAMES[i]) == 0) {
+            arg.keyword = i;
+            return true;
+        }
+    }
+
+    const char* digits = token;
+    int base = 10;
+    size_t maxDigits = 9;
+    if (token[0] == '0' && token[1] == 'X') {
+        digits = token + 2;
+        base = 16;
+        maxDigits = 8;
+    }
+
+    size_t count = strlen(digits);
+    if (count == 0 || count > maxDigits) {
+        return true;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (base == 16 ? !isxdigit((unsigned char)digits[i]) : !isdigit((unsigned char)digits[i])) {
+            return true;
+        }
+    }
+
+    arg.isNumber = true;
+    arg.number = strtoul(digits, nullptr, base);
+    return true;
+}
+
+bool ConfigParser::decodeBinaryArgs(const uint8_t* data, size_t length, ConfigArgs& args) {
+    args.count = 0;
+    args.binary = true;
+
+    size_t offset = 0;
+    while (offset < length) {
+        if (args.count >= ConfigArgs::MAX_ARGS) {
+            return false;
+        }
+
+        ConfigArg& arg = args.items[args.count++];
+        arg.text = nullptr;
+        arg.keyword = KEYWORD_NONE;
+        arg.isNumber = false;
+        arg.number = 0;
+
+        if (data[offset] == CONFIG_ARG_KEYWORD && offset + 2 <= length) {
+            arg.keyword = data[offset + 1];
+            offset += 2;
+        } else if (data[offset] == CONFIG_ARG_NUMBER && offset + 5 <= length) {
+            arg.isNumber = true;
+            arg.number = (uint32_t)data[offset + 1] | ((uint32_t)data[offset + 2] << 8) |
+                         ((uint32_t)data[offset + 3] << 16) | ((uint32_t)data[offset + 4] << 24);
+            offset += 5;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+ConfigParser::CommandResult ConfigParser::handleAdd(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    return addRange(args, 0, context.buses.getBus(getSelectedBus(context)).getAddressFilter(), response);
+}
+
+ConfigParser::CommandResult ConfigParser::handleList(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    AddressFilter& filter = context.buses.getBus(getSelectedBus(context)).getAddressFilter();
+    response.append("Active address ranges:\n");
     int count = filter.getRangeCount();
-    
+
     if (count == 0) {
-        response += "No ranges configured.";
+        response.append("No ranges configured.");
     } else {
         for (int i = 0; i < count; i++) {
             AddressRange range = filter.getRange(i);
-            response += String(i) + ": 0x" + String(range.minAddress, HEX) + 
-                       "-0x" + String(range.maxAddress, HEX) + 
-                       (range.enabled ? " (enabled)" : " (disabled)") + "\n";
+            response.appendf("%d: 0x%x-0x%x %s ", i, range.minAddress, range.maxAddress,
+                             range.enabled ? "(enabled)" : "(disabled)");
+            describePolicy(range.policy, response);
+            response.appendf(", %lu suppressed\n", (unsigned long)range.suppressed);
+        }
+    }
+
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleClear(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    context.buses.getBus(getSelectedBus(context)).getAddressFilter().clearRanges();
+    response.append("All address ranges cleared.");
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleSample(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    AddressFilter& filter = context.buses.getBus(getSelectedBus(context)).getAddressFilter();
+
+    SamplingPolicy policy;
+    if (args.count < 2 || !args.items[0].isNumber ||
+        parseSamplingPolicy(args, 1, policy) != args.count - 1) {
+        response.append("ERROR: Use SAMPLE <index> RATE <n>|EVERY <n>|FIRST <n>|ALL.");
+        return INVALID_PARAMETERS;
+    }
+
+    uint32_t index = args.items[0].number;
+    if (index > (uint32_t)AddressFilter::MAX_RANGES || !filter.setRangePolicy(index, policy)) {
+        response.appendf("ERROR: No range at index %lu. Send LIST to see ranges.", (unsigned long)index);
+        return OUT_OF_RANGE;
+    }
+
+    response.appendf("Range %lu sampling: ", (unsigned long)index);
+    describePolicy(policy, response);
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleMode(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    I2CListener& listener = context.buses.getBus(getSelectedBus(context));
+
+    if (args.count > 0) {
+        I2CCaptureMode mode;
+        if (args.count == 1 && isKeyword(args, 0, KEYWORD_DECODE)) {
+            mode = CAPTURE_DECODE;
+        } else if (args.count == 1 && isKeyword(args, 0, KEYWORD_RAW)) {
+            mode = CAPTURE_RAW_SERIAL;
+        } else if (args.count == 2 && isKeyword(args, 0, KEYWORD_RAW) && isKeyword(args, 1, KEYWORD_BLE)) {
+            mode = CAPTURE_RAW_BLE;
+        } else {
+            response.append("ERROR: Unknown mode. Use MODE DECODE, MODE RAW or MODE RAW BLE.");
+            return INVALID_PARAMETERS;
+        }
+
+        if (mode != CAPTURE_DECODE) {
+            // Edge blocks carry no bus tag, so only one bus may stream them
+            for (int bus = 0; bus < context.buses.getBusCount(); bus++) {
+                if (bus != getSelectedBus(context) && context.buses.getBus(bus).getCaptureMode() != CAPTURE_DECODE) {
+                    response.appendf("ERROR: Bus %d is already in RAW mode.", bus);
+                    return INVALID_PARAMETERS;
+                }
+            }
+        }
+        listener.setCaptureMode(mode);
+    }
+
+    switch (listener.getCaptureMode()) {
+        case CAPTURE_DECODE:
+            response.append("Capture mode: DECODE");
+            break;
+        case CAPTURE_RAW_SERIAL:
+            response.append("Capture mode: RAW (serial)");
+            break;
+        case CAPTURE_RAW_BLE:
+            response.append("Capture mode: RAW (serial + BLE)");
+            break;
+    }
+    response.appendf("\nDropped edges: %lu", (unsigned long)listener.getDroppedEdgeCount());
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleBus(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (args.count > 0) {
+        const ConfigArg& index = args.items[0];
+        if (!index.isNumber || index.number > I2CBusGroup::MAX_BUSES || !context.buses.isValidBus(index.number)) {
+            response.append("ERROR: Unknown bus. Send BUS to list buses.");
+            return OUT_OF_RANGE;
+        }
+        if (context.client) {
+            context.client->selectedBus = index.number;
+        } else {
+            context.selectedBus = index.number;
+        }
+    }
+
+    response.appendf("I2C buses (selected: %d):\n", getSelectedBus(context));
+    for (int bus = 0; bus < context.buses.getBusCount(); bus++) {
+        I2CListener& listener = context.buses.getBus(bus);
+        response.appendf("%d: SDA GPIO%d, SCL GPIO%d, %lu captured, %lu dropped, %d ranges\n",
+                         bus, listener.getSDAPin(), listener.getSCLPin(),
+                         (unsigned long)listener.getCapturedTransactionCount(),
+                         (unsigned long)listener.getDroppedTransactionCount(),
+                         listener.getAddressFilter().getRangeCount());
+    }
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleShadow(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    RegisterShadow& shadow = context.buses.getBus(getSelectedBus(context)).getRegisterShadow();
+
+    if (isKeyword(args, 0, KEYWORD_ON)) {
+        shadow.setDiffMode(true);
+        response.append("Register diff streaming enabled.");
+    } else if (isKeyword(args, 0, KEYWORD_OFF)) {
+        shadow.setDiffMode(false);
+        response.append("Register diff streaming disabled.");
+    } else if (isKeyword(args, 0, KEYWORD_CLEAR)) {
+        shadow.clear();
+        response.append("Register shadow cleared.");
+    } else if (isKeyword(args, 0, KEYWORD_DUMP)) {
+        response.append("Register shadow:\n");
+        for (int i = 0; i < shadow.getDeviceCount(); i++) {
+            ShadowDeviceStats stats = shadow.getDeviceStats(i);
+            response.appendf("0x%x:", stats.address);
+            for (int reg = 0; reg < RegisterShadow::REGISTER_COUNT; reg++) {
+                uint8_t value;
+                if (shadow.getRegister(i, reg, value)) {
+                    response.appendf(" %x=%x", reg, value);
+                }
+            }
+            response.append("\n");
         }
+    } else if (args.count == 0) {
+        response.appendf("Register diff streaming: %s\n", shadow.isDiffMode() ? "ON" : "OFF");
+        response.appendf("Mirrored devices: %d/%d", shadow.getDeviceCount(), RegisterShadow::MAX_DEVICES);
+    } else {
+        response.append("ERROR: Use SHADOW ON, SHADOW OFF, SHADOW CLEAR or SHADOW DUMP.");
+        return INVALID_PARAMETERS;
+    }
+
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleOutput(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    OutputSettings& output = context.output;
+
+    if (isKeyword(args, 0, KEYWORD_TEXT)) {
+        output.serialMode = SERIAL_TEXT;
+    } else if (isKeyword(args, 0, KEYWORD_BINARY)) {
+        output.serialMode = SERIAL_BINARY;
+    } else if (args.count > 0) {
+        response.append("ERROR: Use OUTPUT TEXT or OUTPUT BINARY.");
+        return INVALID_PARAMETERS;
+    }
+
+    response.appendf("Serial output: %s", output.serialMode == SERIAL_BINARY ? "BINARY" : "TEXT");
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleFormat(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (args.count > 0 && !parseFormat(args, 0, context.output.dataFormat)) {
+        response.append("ERROR: Use FORMAT HEX, FORMAT BIN or FORMAT DEC.");
+        return INVALID_PARAMETERS;
+    }
+
+    response.appendf("Data format: %s", formatName(context.output.dataFormat));
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleBoot(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (isKeyword(args, 0, KEYWORD_FAST)) {
+        context.settings.setFastStart(true);
+    } else if (isKeyword(args, 0, KEYWORD_NORMAL)) {
+        context.settings.setFastStart(false);
+    } else if (args.count > 0) {
+        response.append("ERROR: Use BOOT FAST or BOOT NORMAL, then SAVE.");
+        return INVALID_PARAMETERS;
+    }
+
+    response.appendf("Boot mode: %s\n", context.settings.isFastStart() ? "FAST" : "NORMAL");
+    response.appendf("Boot to capture: %lu us", (unsigned long)context.buses.getBus(0).getCaptureStartMicros());
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleSave(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (!context.settings.save(context.buses, context.output)) {
+        response.append("ERROR: Could not write settings to flash.");
+        return INVALID_COMMAND;
+    }
+    response.append("Settings saved.");
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleLoad(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (!context.settings.load(context.buses, context.output)) {
+        response.append("ERROR: No saved settings found.");
+        return INVALID_COMMAND;
+    }
+    response.append("Settings loaded.");
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleReset(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (!context.settings.reset(context.buses, context.output)) {
+        response.append("ERROR: Could not erase saved settings.");
+        return INVALID_COMMAND;
+    }
+    response.append("Settings reset to defaults.");
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleLatency(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (!context.client) {
+        response.append("ERROR: LATENCY applies to a BLE client. Send it over the config characteristic.");
+        return INVALID_COMMAND;
+    }
+
+    if (isKeyword(args, 0, KEYWORD_ON)) {
+        context.client->latencyStamps = true;
+    } else if (isKeyword(args, 0, KEYWORD_OFF)) {
+        context.client->latencyStamps = false;
+    } else if (args.count > 0) {
+        response.append("ERROR: Use LATENCY ON or LATENCY OFF.");
+        return INVALID_PARAMETERS;
+    }
+
+    response.appendf("Latency stamps: %s", context.client->latencyStamps ? "ON" : "OFF");
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleCompress(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (!context.client) {
+        response.append("ERROR: COMPRESS applies to a BLE client. Send it over the config characteristic.");
+        return INVALID_COMMAND;
+    }
+
+    if (isKeyword(args, 0, KEYWORD_ON)) {
+        context.client->compression = true;
+    } else if (isKeyword(args, 0, KEYWORD_OFF)) {
+        context.client->compression = false;
+    } else if (args.count > 0) {
+        response.append("ERROR: Use COMPRESS ON or COMPRESS OFF.");
+        return INVALID_PARAMETERS;
+    }
+
+    response.appendf("BLE compression: %s", context.client->compression ? "ON" : "OFF");
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleClient(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    ClientSession* client = context.client;
+    if (!client) {
+        response.append("ERROR: CLIENT applies to a BLE client. Send it over the config characteristic.");
+        return INVALID_COMMAND;
+    }
+
+    if (isKeyword(args, 0, KEYWORD_ADD)) {
+        return addRange(args, 1, client->filter, response);
+    } else if (isKeyword(args, 0, KEYWORD_CLEAR) && args.count == 1) {
+        client->filter.clearRanges();
+    } else if (isKeyword(args, 0, KEYWORD_FORMAT) && args.count == 1) {
+        client->hasFormat = false;
+    } else if (isKeyword(args, 0, KEYWORD_FORMAT) && args.count == 2) {
+        if (!parseFormat(args, 1, client->format)) {
+            response.append("ERROR: Use CLIENT FORMAT HEX, BIN or DEC, or CLIENT FORMAT alone for the device format.");
+            return INVALID_PARAMETERS;
+        }
+        client->hasFormat = true;
+    } else if (args.count > 0) {
+        response.append("ERROR: Use CLIENT, CLIENT ADD <range> [policy], CLIENT CLEAR or CLIENT FORMAT [HEX|BIN|DEC].");
+        return INVALID_PARAMETERS;
+    }
+
+    response.appendf("Client %u\n", client->clientId);
+    response.appendf("Format: %s%s\n", formatName(ClientSessions::formatFor(*client, context.output)),
+                     client->hasFormat ? "" : " (device)");
+    response.appendf("Latency stamps: %s, compression: %s\n",
+                     client->latencyStamps ? "ON" : "OFF", client->compression ? "ON" : "OFF");
+
+    int count = client->filter.getRangeCount();
+    if (count == 0) {
+        response.append("Ranges: all captured traffic");
+    }
+    for (int i = 0; i < count; i++) {
+        AddressRange range = client->filter.getRange(i);
+        response.appendf("%d: 0x%x-0x%x ", i, range.minAddress, range.maxAddress);
+        describePolicy(range.policy, response);
+        response.appendf(", %lu suppressed\n", (unsigned long)range.suppressed);
+    }
+    return SUCCESS;
+}
+
+ConfigParser::CommandResult ConfigParser::handleDissect(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    DissectorEngine& engine = context.dissectors;
+    uint8_t bus = getSelectedBus(context);
+    uint8_t address;
+
+    if (isKeyword(args, 0, KEYWORD_CLEAR) && args.count == 1) {
+        engine.clear();
+        response.append("All dissector bindings removed.");
+        return SUCCESS;
+    }
+
+    if (isKeyword(args, 0, KEYWORD_WINDOW)) {
+        if (args.count != 2 || !args.items[1].isNumber) {
+            response.append("ERROR: Use DISSECT WINDOW <ms>, 0 for every value.");
+            return INVALID_PARAMETERS;
+        }
+        engine.setWindow(args.items[1].number);
+        response.appendf("Dissector window: %lu ms", (unsigned long)engine.getWindow());
+        return SUCCESS;
+    }
+
+    if (args.count == 2) {
+        if (!parseAddress(args.items[0], address) || address < 0x08 || address > 0x77) {
+            response.append("ERROR: Invalid address. Use 0x08-0x77.");
+            return INVALID_PARAMETERS;
+        }
+
+        if (isKeyword(args, 1, KEYWORD_OFF)) {
+            if (!engine.unbind(bus, address)) {
+                response.appendf("ERROR: No dissector on 0x%02X.", address);
+                return OUT_OF_RANGE;
+            }
+            response.appendf("Dissector removed from 0x%02X.", address);
+            return SUCCESS;
+        }
+
+        // Binary clients pass the registry index shown by DISSECT
+        const ConfigArg& name = args.items[1];
+        int dissector = name.isNumber ? (int)name.number
+                                      : (name.text ? DissectorEngine::findDissector(name.text) : -1);
+        if (dissector < 0 || !engine.bind(bus, address, dissector)) {
+            response.append("ERROR: Unknown dissector or all bindings in use. Send DISSECT to list them.");
+            return OUT_OF_RANGE;
+        }
+        response.appendf("0x%02X on bus %d decoded as %s", address, bus, DissectorEngine::getDissector(dissector).name);
+        return SUCCESS;
+    }
+
+    if (args.count > 0) {
+        response.append("ERROR: Use DISSECT, DISSECT <addr> <name>|OFF, DISSECT WINDOW <ms> or DISSECT CLEAR.");
+        return INVALID_PARAMETERS;
+    }
+
+    response.append("Dissectors:");
+    for (size_t i = 0; i < DissectorEngine::getDissectorCount(); i++) {
+        const DissectorEntry& entry = DissectorEngine::getDissector(i);
+        response.appendf(" %u:%s(0x%02X-0x%02X)", (unsigned)i, entry.name, entry.minAddress, entry.maxAddress);
+    }
+    response.appendf("\nWindow: %lu ms", (unsigned long)engine.getWindow());
+
+    const DissectorBinding* binding;
+    for (int i = 0; (binding = engine.getBinding(i)) != nullptr; i++) {
+        response.appendf("\nBus %d 0x%02X: %s", binding->busId, binding->address,
+                         DissectorEngine::getDissector(binding->dissector).name);
     }
-    
     return SUCCESS;
 }
 
-ConfigParser::CommandResult ConfigParser::parseClearRanges(AddressFilter& filter, String& response) {
-    filter.clearRanges();
-    response = "All address ranges cleared.";
+ConfigParser::CommandResult ConfigParser::handleStats(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    Telemetry& telemetry = context.telemetry;
+
+    // Binary batches get the packed record described in Telemetry.h
+    if (args.binary) {
+        uint8_t record[Telemetry::MAX_RECORD_SIZE];
+        response.append(record, telemetry.encodeRecord(context.buses, record));
+        return SUCCESS;
+    }
+
+    const TelemetrySample& sample = telemetry.getLatest();
+    response.appendf("Uptime: %lu s, %lu samples (%u us each)\n", (unsigned long)(sample.uptimeMillis / 1000),
+                     (unsigned long)telemetry.getSampleCount(), sample.sampleMicros);
+    response.appendf("Heap: %lu free, %lu largest block, %lu min free, %lu min largest%s\n",
+                     (unsigned long)sample.freeHeap, (unsigned long)sample.largestFreeBlock,
+                     (unsigned long)sample.minFreeHeap, (unsigned long)sample.minLargestFreeBlock,
+                     telemetry.isLowHeap() ? " (LOW)" : "");
+
+    response.append("Stack free:");
+    for (int i = 0; i < telemetry.getTaskCount(); i++) {
+        response.appendf(" %s %u", telemetry.getTaskName(i), telemetry.getStackHighWater(i));
+    }
+
+    for (int bus = 0; bus < context.buses.getBusCount(); bus++) {
+        I2CListener& listener = context.buses.getBus(bus);
+        response.appendf("\nBus %d queue: %u/%u, peak %u, %u edges pending, %lu dropped", bus,
+                         (unsigned)listener.getQueueDepth(), (unsigned)listener.getQueueCapacity(),
+                         (unsigned)listener.getPeakQueueDepth(), (unsigned)listener.getEdgeBacklog(),
+                         (unsigned long)listener.getDroppedTransactionCount());
+    }
     return SUCCESS;
 }
 
-ConfigParser::CommandResult ConfigParser::parseHelp(String& response) {
-    response = "I2C Address Filter Commands:\n";
-    response += "ADD 0x08-0x77  - Add address range\n";
-    response += "ADD 0x50       - Add single address\n";
-    response += "LIST           - List current ranges\n";
-    response += "CLEAR          - Clear all ranges\n";
-    response += "HELP           - Show this help\n";
-    response += "\nExample: ADD 0x08-0x0F";
+ConfigParser::CommandResult ConfigParser::handleSync(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    if (args.count != 1 || !args.items[0].isNumber) {
+        response.append("ERROR: Use SYNC <reference>.");
+        return INVALID_PARAMETERS;
+    }
+
+    // The host pairs the echoed reference with its send and receive times
+    response.appendf("SYNC %lu %lu", (unsigned long)args.items[0].number, (unsigned long)micros());
     return SUCCESS;
 }
 
-uint8_t ConfigParser::parseHexByte(const String& hexStr) {
-    String str = hexStr;
-    if (str.startsWith("0x") || str.startsWith("0X")) {
-        str = str.substring(2);
+ConfigParser::CommandResult ConfigParser::handleHelp(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response) {
+    response.append("I2C Address Filter Commands:\n");
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        response.append(COMMANDS[i].help);
     }
-    
-    return (uint8_t)strtol(str.c_str(), NULL, 16);
+    response.append("\nSeparate commands with ';' or newlines.");
+    response.append("\nExample: ADD 0x08-0x0F; LIST");
+    return SUCCESS;
 }
 
-bool ConfigParser::isValidHex(const String& str) {
-    String trimmed = str;
-    trimmed.trim();
-    
-    if (trimmed.startsWith("0x") || trimmed.startsWith("0X")) {
-        trimmed = trimmed.substring(2);
+ConfigParser::CommandResult ConfigParser::addRange(const ConfigArgs& args, int index, AddressFilter& filter, ConfigResponse& response) {
+    uint8_t startAddr;
+    if (args.count <= index || !parseAddress(args.items[index], startAddr)) {
+        response.append("ERROR: Invalid hex address format. Use 0x08-0x77 format.");
+        return INVALID_PARAMETERS;
     }
-    
-    if (trimmed.length() == 0 || trimmed.length() > 2) {
+
+    uint8_t endAddr = startAddr;
+    int next = index + 1;
+    if (isKeyword(args, next, KEYWORD_DASH)) {
+        if (args.count < next + 2 || !parseAddress(args.items[next + 1], endAddr)) {
+            response.append("ERROR: Invalid hex format. Use 0x08-0x77 format.");
+            return INVALID_PARAMETERS;
+        }
+        next += 2;
+    }
+
+    // Optional trailing sampling policy, e.g. "ADD 0x48 RATE 100"
+    SamplingPolicy policy = {SAMPLE_ALL, 0};
+    if (next < args.count && parseSamplingPolicy(args, next, policy) != args.count - next) {
+        response.append("ERROR: Invalid sampling policy. Use RATE <n>, EVERY <n>, FIRST <n> or ALL.");
+        return INVALID_PARAMETERS;
+    }
+
+    if (!filter.addRange(startAddr, endAddr, policy)) {
+        response.append("ERROR: Could not add range. Check addresses are valid (0x08-0x77), start <= end and the range limit.");
+        return OUT_OF_RANGE;
+    }
+
+    response.appendf("Added address range: 0x%x-0x%x (", startAddr, endAddr);
+    describePolicy(policy, response);
+    response.append(")");
+    return SUCCESS;
+}
+
+int ConfigParser::getSelectedBus(const ConfigContext& context) {
+    // Each BLE client selects its own bus so one client's BUS never retargets another's ADD
+    return context.client ? context.client->selectedBus : context.selectedBus;
+}
+
+bool ConfigParser::isKeyword(const ConfigArgs& args, int index, uint8_t keyword) {
+    return index < args.count && args.items[index].keyword == keyword;
+}
+
+bool ConfigParser::parseAddress(const ConfigArg& arg, uint8_t& address) {
+    if (!arg.text) {
+        if (!arg.isNumber || arg.number > 0xFF) {
+            return false;
+        }
+        address = arg.number;
+        return true;
+    }
+
+    // Text addresses are always hex, with or without the 0x prefix
+    const char* digits = arg.text;
+    if (digits[0] == '0' && digits[1] == 'X') {
+        digits += 2;
+    }
+
+    size_t count = strlen(digits);
+    if (count == 0 || count > 2) {
         return false;
     }
-    
-    for (int i = 0; i < trimmed.length(); i++) {
-        char c = trimmed.charAt(i);
-        if (!isDigit(c) && c != 'A' && c != 'B' && c != 'C' && 
-            c != 'D' && c != 'E' && c != 'F') {
+    for (size_t i = 0; i < count; i++) {
+        if (!isxdigit((unsigned char)digits[i])) {
             return false;
         }
     }
-    
+
+    address = strtoul(digits, nullptr, 16);
+    return true;
+}
+
+bool ConfigParser::parseFormat(const ConfigArgs& args, int index, I2CFormatterType& format) {
+    if (isKeyword(args, index, KEYWORD_HEX)) {
+        format = I2CFormatterType::Hex;
+    } else if (isKeyword(args, index, KEYWORD_BIN)) {
+        format = I2CFormatterType::Binary;
+    } else if (isKeyword(args, index, KEYWORD_DEC)) {
+        format = I2CFormatterType::Decimal;
+    } else {
+        return false;
+    }
     return true;
-}
\ No newline at end of file
+}
+
+const char* ConfigParser::formatName(I2CFormatterType format) {
+    switch (format) {
+        case I2CFormatterType::Hex:
+            return "HEX";
+        case I2CFormatterType::Decimal:
+            return "DEC";
+        case I2CFormatterType::Binary:
+        default:
+            return "BIN";
+    }
+}
+
+int ConfigParser::parseSamplingPolicy(const ConfigArgs& args, int index, SamplingPolicy& policy) {
+    if (isKeyword(args, index, KEYWORD_ALL)) {
+        policy = {SAMPLE_ALL, 0};
+        return 1;
+    }
+
+    if (isKeyword(args, index, KEYWORD_RATE)) {
+        policy.mode = SAMPLE_RATE;
+    } else if (isKeyword(args, index, KEYWORD_EVERY)) {
+        policy.mode = SAMPLE_DECIMATE;
+    } else if (isKeyword(args, index, KEYWORD_FIRST)) {
+        policy.mode = SAMPLE_FIRST;
+    } else {
+        return 0;
+    }
+
+    if (index + 1 >= args.count || !args.items[index + 1].isNumber) {
+        return 0;
+    }
+
+    policy.limit = args.items[index + 1].number;
+    return AddressFilter::isValidPolicy(policy) ? 2 : 0;
+}
+
+void ConfigParser::describePolicy(const SamplingPolicy& policy, ConfigResponse& response) {
+    switch (policy.mode) {
+        case SAMPLE_RATE:
+            response.appendf("max %lu/s", (unsigned long)policy.limit);
+            break;
+        case SAMPLE_DECIMATE:
+            response.appendf("1 in %lu", (unsigned long)policy.limit);
+            break;
+        case SAMPLE_FIRST:
+            response.appendf("first %lu", (unsigned long)policy.limit);
+            break;
+        case SAMPLE_ALL:
+        default:
+            response.append("all");
+            break;
+    }
+}
@@ -3,6 +3,93 @@
 
 #include <Arduino.h>
 #include "AddressFilter.h"
+#include "ClientSession.h"
+#include "Dissector.h"
+#include "I2CBusGroup.h"
+#include "I2CFormatter.h"
+#include "SettingsStore.h"
+#include "Telemetry.h"
+
+// Binary writes start with this byte; text commands are always ASCII
+#define CONFIG_BINARY_MARKER 0xB1
+
+// Binary argument tags: [ARG_KEYWORD id] or [ARG_NUMBER u32 LE]
+#define CONFIG_ARG_KEYWORD 0x01
+#define CONFIG_ARG_NUMBER  0x02
+
+enum ConfigKeyword {
+    KEYWORD_NONE,
+    KEYWORD_DASH,
+    KEYWORD_ON,
+    KEYWORD_OFF,
+    KEYWORD_CLEAR,
+    KEYWORD_DUMP,
+    KEYWORD_ALL,
+    KEYWORD_RATE,
+    KEYWORD_EVERY,
+    KEYWORD_FIRST,
+    KEYWORD_DECODE,
+    KEYWORD_RAW,
+    KEYWORD_BLE,
+    KEYWORD_TEXT,
+    KEYWORD_BINARY,
+    KEYWORD_HEX,
+    KEYWORD_BIN,
+    KEYWORD_DEC,
+    KEYWORD_FAST,
+    KEYWORD_NORMAL,
+    KEYWORD_ADD,
+    KEYWORD_FORMAT,
+    KEYWORD_WINDOW
+};
+
+struct ConfigContext {
+    I2CBusGroup& buses;
+    int selectedBus;  // BUS selection for a sender without a session; clients keep their own
+    OutputSettings& output;
+    SettingsStore& settings;
+    Telemetry& telemetry;
+    DissectorEngine& dissectors;
+    ClientSession* client;  // Sender's session, nullptr until the loop has opened it
+};
+
+struct ConfigArg {
+    uint8_t keyword;     // ConfigKeyword, KEYWORD_NONE for numbers and unknown words
+    bool isNumber;
+    uint32_t number;
+    const char* text;    // Upper-cased token for text commands, nullptr for binary
+};
+
+struct ConfigArgs {
+    static const int MAX_ARGS = 8;
+    ConfigArg items[MAX_ARGS];
+    int count;
+    bool binary;         // Decoded from a TLV batch
+};
+
+// Fixed-size response buffer; output past CAPACITY is dropped and flagged
+class ConfigResponse {
+public:
+    static const size_t CAPACITY = 4096;
+
+    ConfigResponse();
+    void clear();
+    void append(const char* text);
+    void append(const uint8_t* bytes, size_t count);
+    void appendByte(uint8_t value);
+    void appendf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void patchByte(size_t offset, uint8_t value);
+
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(buffer); }
+    const char* c_str() const { return buffer; }
+    size_t length() const { return used; }
+    bool isTruncated() const { return truncated; }
+
+private:
+    char buffer[CAPACITY + 1];
+    size_t used;
+    bool truncated;
+};
 
 class ConfigParser {
 public:
@@ -12,16 +99,66 @@ public:
         INVALID_PARAMETERS,
         OUT_OF_RANGE
     };
-    
-    static CommandResult parseCommand(const String& command, AddressFilter& filter, String& response);
-    
+
+    static const size_t MAX_COMMAND_LENGTH = 96;
+
+    // One BLE write: text commands separated by newlines or ';', or a binary
+    // TLV batch. Returns the first failure, or SUCCESS if every command ran.
+    static CommandResult parseBatch(const uint8_t* data, size_t length, ConfigContext& context, ConfigResponse& response);
+    static CommandResult parseCommand(const char* command, size_t length, ConfigContext& context, ConfigResponse& response);
+    static bool isBinary(const uint8_t* data, size_t length);
+
 private:
-    static CommandResult parseAddressRange(const String& params, AddressFilter& filter, String& response);
-    static CommandResult parseListRanges(AddressFilter& filter, String& response);
-    static CommandResult parseClearRanges(AddressFilter& filter, String& response);
-    static CommandResult parseHelp(String& response);
-    static uint8_t parseHexByte(const String& hexStr);
-    static bool isValidHex(const String& str);
+    typedef CommandResult (*CommandHandler)(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+
+    struct CommandEntry {
+        const char* name;
+        uint8_t opcode;     // Binary TLV type
+        int maxArgs;
+        CommandHandler handler;
+        const char* help;
+    };
+
+    static const CommandEntry COMMANDS[];
+    static const size_t COMMAND_COUNT;
+
+    static CommandResult parseBinaryCommand(uint8_t opcode, const uint8_t* args, size_t length, ConfigContext& context, ConfigResponse& response);
+    static CommandResult dispatch(const CommandEntry* entry, const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static const CommandEntry* findCommand(const char* name);
+    static const CommandEntry* findOpcode(uint8_t opcode);
+    static bool tokenize(char* line, const char*& name, ConfigArgs& args);
+    static bool addTextArg(const char* token, ConfigArgs& args);
+    static bool decodeBinaryArgs(const uint8_t* data, size_t length, ConfigArgs& args);
+
+    static CommandResult handleAdd(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleList(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleClear(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleSample(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleMode(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleBus(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleShadow(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleOutput(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleFormat(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleBoot(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleSave(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleLoad(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleReset(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleLatency(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleCompress(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleClient(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleDissect(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleStats(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleSync(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+    static CommandResult handleHelp(const ConfigArgs& args, ConfigContext& context, ConfigResponse& response);
+
+    static CommandResult addRange(const ConfigArgs& args, int index, AddressFilter& filter, ConfigResponse& response);
+    static bool isKeyword(const ConfigArgs& args, int index, uint8_t keyword);
+    static int getSelectedBus(const ConfigContext& context);  // Target of filter, shadow and mode commands
+    static bool parseFormat(const ConfigArgs& args, int index, I2CFormatterType& format);
+    static const char* formatName(I2CFormatterType format);
+    static bool parseAddress(const ConfigArg& arg, uint8_t& address);
+    static int parseSamplingPolicy(const ConfigArgs& args, int index, SamplingPolicy& policy);
+    static void describePolicy(const SamplingPolicy& policy, ConfigResponse& response);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,206 @@
+#include "Dissector.h"
+#include <Arduino.h>
+#include <string.h>
+
+DissectorEngine::DissectorEngine() : windowMillis(0) {
+    clear();
+}
+
+size_t DissectorEngine::getDissectorCount() {
+    return REGISTRY_COUNT;
+}
+
+const DissectorEntry& DissectorEngine::getDissector(size_t index) {
+    return REGISTRY[index];
+}
+
+int DissectorEngine::findDissector(const char* name) {
+    for (size_t i = 0; i < REGISTRY_COUNT; i++) {
+        if (strcmp(REGISTRY[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool DissectorEngine::bind(uint8_t busId, uint8_t address, size_t dissector) {
+    if (dissector >= REGISTRY_COUNT) {
+        return false;
+    }
+
+    Slot* slot = find(busId, address);
+    for (int i = 0; !slot && i < MAX_BINDINGS; i++) {
+        if (!slots[i].active) {
+            slot = &slots[i];
+        }
+    }
+    if (!slot) {
+        return false;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    slot->active = true;
+    slot->binding.busId = busId;
+    slot->binding.address = address;
+    slot->binding.dissector = dissector;
+    return true;
+}
+
+bool DissectorEngine::unbind(uint8_t busId, uint8_t address) {
+    Slot* slot = find(busId, address);
+    if (!slot) {
+        return false;
+    }
+    slot->active = false;
+    return true;
+}
+
+void DissectorEngine::clear() {
+    memset(slots, 0, sizeof(slots));
+}
+
+int DissectorEngine::getBindingCount() {
+    int count = 0;
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        count += slots[i].active ? 1 : 0;
+    }
+    return count;
+}
+
+const DissectorBinding* DissectorEngine::getBinding(int index) {
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        if (slots[i].active && index-- == 0) {
+            return &slots[i].binding;
+        }
+    }
+    return nullptr;
+}
+
+void DissectorEngine::setWindow(uint32_t milliseconds) {
+    windowMillis = milliseconds;
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        resetWindows(slots[i]);
+    }
+}
+
+uint32_t DissectorEngine::getWindow() {
+    return windowMillis;
+}
+
+DissectorEngine::Result DissectorEngine::process(const I2CTransaction& transaction, DissectorRecord& record) {
+    Slot* slot = find(transaction.busId, transaction.address);
+    if (!slot || transaction.hasError || transaction.data == nullptr || transaction.dataLength == 0) {
+        return NOT_DISSECTED;
+    }
+
+    const DissectorEntry& entry = REGISTRY[slot->binding.dissector];
+    DissectorCheck check = CHECK_NONE;
+    int count = entry.decode(slot->binding.state, transaction, record.values, check);
+    if (count < 0) {
+        return NOT_DISSECTED;
+    }
+    if (count == 0) {
+        return ABSORBED;
+    }
+
+    record.dissector = &entry;
+    record.busId = transaction.busId;
+    record.address = transaction.address;
+    record.timestamp = transaction.timestamp;
+    record.check = check;
+    record.count = count;
+
+    // Failed checks are always reported on their own
+    if (windowMillis == 0 || check == CHECK_FAILED) {
+        return DISSECTED;
+    }
+
+    bool aggregated = false;
+    for (size_t i = 0; i < record.count; i++) {
+        const DissectorValue& value = record.values[i];
+        if (entry.channels[value.channel].hex) {
+            continue;
+        }
+
+        if (!slot->windowOpen) {
+            slot->windowOpen = true;
+            slot->windowStart = millis();
+            slot->firstTimestamp = transaction.timestamp;
+        }
+        ChannelWindow& window = slot->windows[value.channel];
+        if (window.count == 0 || value.value < window.minValue) {
+            window.minValue = value.value;
+        }
+        if (window.count == 0 || value.value > window.maxValue) {
+            window.maxValue = value.value;
+        }
+        window.sum += value.value;
+        window.count++;
+        aggregated = true;
+    }
+    return aggregated ? ABSORBED : DISSECTED;
+}
+
+bool DissectorEngine::collectWindow(DissectorWindow& window) {
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        Slot& slot = slots[i];
+        if (!slot.active || !slot.windowOpen) {
+            continue;
+        }
+        if (millis() - slot.windowStart < windowMillis) {
+            continue;
+        }
+
+        const DissectorEntry& entry = REGISTRY[slot.binding.dissector];
+        for (int channel = 0; channel < entry.channelCount; channel++) {
+            ChannelWindow& open = slot.windows[channel];
+            if (open.count == 0) {
+                continue;
+            }
+
+            window.dissector = &entry;
+            window.busId = slot.binding.busId;
+            window.address = slot.binding.address;
+            window.channel = channel;
+            window.timestamp = slot.firstTimestamp;
+            window.minValue = open.minValue;
+            window.maxValue = open.maxValue;
+            window.meanValue = open.sum / (int64_t)open.count;
+            window.count = open.count;
+            open.count = 0;
+            open.sum = 0;
+            return true;
+        }
+        slot.windowOpen = false;
+    }
+    return false;
+}
+
+bool DissectorEngine::getDeadline(unsigned long& deadline) {
+    bool found = false;
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        if (!slots[i].active || !slots[i].windowOpen) {
+            continue;
+        }
+        unsigned long due = slots[i].windowStart + windowMillis;
+        if (!found || (long)(due - deadline) < 0) {
+            deadline = due;
+            found = true;
+        }
+    }
+    return found;
+}
+
+DissectorEngine::Slot* DissectorEngine::find(uint8_t busId, uint8_t address) {
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        if (slots[i].active && slots[i].binding.busId == busId && slots[i].binding.address == address) {
+            return &slots[i];
+        }
+    }
+    return nullptr;
+}
+
+void DissectorEngine::resetWindows(Slot& slot) {
+    slot.windowOpen = false;
+    memset(slot.windows, 0, sizeof(slot.windows));
+}
@@ -0,0 +1,151 @@
+#ifndef DISSECTOR_H
+#define DISSECTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I2CDecoder.h"
+
+// Protocol dissectors turn drained transactions from a known device into
+// decoded values. A dissector is bound to an address on one bus; bound
+// traffic is reported as value records, or folded into min/max/mean windows,
+// instead of raw bytes. Transactions a dissector cannot decode (setup writes,
+// unknown registers) still go out raw.
+//
+// The registry is a table fixed at compile time (SensorDissectors.cpp). Each
+// dissector sits behind a DISSECTOR_<NAME> flag, default 1; building with
+// e.g. -DDISSECTOR_MPU6050=0 leaves its code out entirely.
+
+static const int DISSECTOR_MAX_CHANNELS = 8;
+
+// Values are fixed point: value / 10^decimals in unit
+struct DissectorChannel {
+    const char* name;
+    const char* unit;
+    uint8_t decimals;
+    bool hex;          // Shown as hex, never aggregated
+};
+
+struct DissectorValue {
+    uint8_t channel;   // Index into the dissector's channels
+    int32_t value;
+};
+
+enum DissectorCheck {
+    CHECK_NONE,        // Protocol has no integrity check
+    CHECK_OK,
+    CHECK_FAILED
+};
+
+// Per-binding state kept between transactions
+struct DissectorState {
+    bool pointerValid;
+    uint8_t pointer;             // Register pointer from the last write
+    uint8_t lastWrite[2];        // Start of the last write, for SMBus PEC
+    uint8_t lastWriteLength;
+    uint8_t config[4];           // Dissector-owned, e.g. full-scale ranges
+};
+
+struct DissectorEntry;
+
+// Called for every transaction on a bound address. Returns the number of
+// values written, 0 for a transaction that only sets up a later one (a
+// register pointer or SMBus command write) and -1 when it cannot be decoded.
+typedef int (*DissectorDecode)(DissectorState& state, const I2CTransaction& transaction,
+                               DissectorValue* values, DissectorCheck& check);
+
+struct DissectorEntry {
+    const char* name;
+    uint8_t minAddress;          // Usual strap range, for listing only
+    uint8_t maxAddress;
+    const DissectorChannel* channels;
+    uint8_t channelCount;
+    DissectorDecode decode;
+};
+
+struct DissectorRecord {
+    const DissectorEntry* dissector;
+    uint8_t busId;
+    uint8_t address;
+    unsigned long timestamp;
+    DissectorCheck check;
+    DissectorValue values[DISSECTOR_MAX_CHANNELS];
+    size_t count;
+};
+
+struct DissectorWindow {
+    const DissectorEntry* dissector;
+    uint8_t busId;
+    uint8_t address;
+    uint8_t channel;
+    unsigned long timestamp;     // First value in the window
+    int32_t minValue;
+    int32_t maxValue;
+    int32_t meanValue;
+    uint32_t count;
+};
+
+struct DissectorBinding {
+    uint8_t busId;
+    uint8_t address;
+    uint8_t dissector;           // Registry index
+    DissectorState state;
+};
+
+class DissectorEngine {
+public:
+    static const int MAX_BINDINGS = 8;
+
+    enum Result {
+        NOT_DISSECTED,           // Send the raw transaction
+        DISSECTED,               // record holds values to send
+        ABSORBED                 // Set-up write or folded into a window, nothing to send now
+    };
+
+private:
+    struct ChannelWindow {
+        int32_t minValue;
+        int32_t maxValue;
+        int64_t sum;
+        uint32_t count;
+    };
+
+    struct Slot {
+        bool active;
+        DissectorBinding binding;
+        bool windowOpen;
+        unsigned long windowStart;  // millis()
+        unsigned long firstTimestamp;
+        ChannelWindow windows[DISSECTOR_MAX_CHANNELS];
+    };
+
+    static const DissectorEntry REGISTRY[];
+    static const size_t REGISTRY_COUNT;
+
+    Slot slots[MAX_BINDINGS];
+    uint32_t windowMillis;          // 0: one record per transaction
+
+public:
+    DissectorEngine();
+    static size_t getDissectorCount();
+    static const DissectorEntry& getDissector(size_t index);
+    static int findDissector(const char* name);
+
+    bool bind(uint8_t busId, uint8_t address, size_t dissector);
+    bool unbind(uint8_t busId, uint8_t address);
+    void clear();
+    int getBindingCount();
+    const DissectorBinding* getBinding(int index);  // nullptr past the last
+    void setWindow(uint32_t milliseconds);  // Drops any open windows
+    uint32_t getWindow();
+
+    Result process(const I2CTransaction& transaction, DissectorRecord& record);
+    // Hands out one finished window per call; false once none are due
+    bool collectWindow(DissectorWindow& window);
+    bool getDeadline(unsigned long& deadline);
+
+private:
+    Slot* find(uint8_t busId, uint8_t address);
+    void resetWindows(Slot& slot);
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "EdgeStream.h"
+#include <string.h>
+
+EdgeBlockWriter::EdgeBlockWriter() : length(0), lastTimestamp(0) {
+    memset(buffer, 0, MAX_BLOCK_SIZE);
+}
+
+void EdgeBlockWriter::begin(uint32_t baseTimestamp) {
+    buffer[0] = BLOCK_MARKER;
+    buffer[1] = 0;
+    buffer[2] = baseTimestamp & 0xFF;
+    buffer[3] = (baseTimestamp >> 8) & 0xFF;
+    buffer[4] = (baseTimestamp >> 16) & 0xFF;
+    buffer[5] = (baseTimestamp >> 24) & 0xFF;
+    length = HEADER_SIZE;
+    lastTimestamp = baseTimestamp;
+}
+
+bool EdgeBlockWriter::append(const I2CEdgeEvent& event) {
+    if (length + MAX_EVENT_SIZE > HEADER_SIZE + MAX_PAYLOAD) {
+        return false;
+    }
+
+    uint32_t delta = event.timestamp - lastTimestamp;
+    lastTimestamp = event.timestamp;
+
+    uint8_t first = (event.lines & 0x07) | ((delta & 0x0F) << 3);
+    delta >>= 4;
+    if (delta) {
+        first |= 0x80;
+    }
+    buffer[length++] = first;
+
+    while (delta) {
+        uint8_t next = delta & 0x7F;
+        delta >>= 7;
+        buffer[length++] = next | (delta ? 0x80 : 0);
+    }
+
+    return true;
+}
+
+bool EdgeBlockWriter::isEmpty() const {
+    return length <= HEADER_SIZE;
+}
+
+size_t EdgeBlockWriter::finish() {
+    buffer[1] = length - HEADER_SIZE;
+
+    uint8_t sum = 0;
+    for (size_t i = 1; i < length; i++) {
+        sum ^= buffer[i];
+    }
+    buffer[length++] = sum;
+    return length;
+}
+
+const uint8_t* EdgeBlockWriter::data() const {
+    return buffer;
+}
+
+size_t EdgeBlockWriter::writeOverrun(uint32_t droppedEdges, uint8_t* out) {
+    out[0] = OVERRUN_MARKER;
+    out[1] = droppedEdges & 0xFF;
+    out[2] = (droppedEdges >> 8) & 0xFF;
+    out[3] = (droppedEdges >> 16) & 0xFF;
+    out[4] = (droppedEdges >> 24) & 0xFF;
+    out[5] = out[1] ^ out[2] ^ out[3] ^ out[4];
+    return OVERRUN_BLOCK_SIZE;
+}
+
+EdgeStreamReader::EdgeStreamReader() :
+    eventHandler(nullptr),
+    overrunHandler(nullptr),
+    handlerContext(nullptr),
+    bufferLength(0),
+    blockCount(0),
+    corruptBlocks(0),
+    skippedBytes(0) {
+}
+
+void EdgeStreamReader::setHandlers(EventHandler onEvent, OverrunHandler onOverrun, void* context) {
+    eventHandler = onEvent;
+    overrunHandler = onOverrun;
+    handlerContext = context;
+}
+
+void EdgeStreamReader::feed(const uint8_t* data, size_t length) {
+    while (length > 0) {
+        size_t chunk = BUFFER_SIZE - bufferLength;
+        if (chunk > length) {
+            chunk = length;
+        }
+        memcpy(buffer + bufferLength, data, chunk);
+        bufferLength += chunk;
+        data += chunk;
+        length -= chunk;
+
+        size_t offset = 0;
+        size_t consumed;
+        while (offset < bufferLength &&
+               (consumed = parseBlock(buffer + offset, bufferLength - offset)) > 0) {
+            offset += consumed;
+        }
+
+        memmove(buffer, buffer + offset, bufferLength - offset);
+        bufferLength -= offset;
+    }
+}
+
+size_t EdgeStreamReader::parseBlock(const uint8_t* block, size_t available) {
+    if (block[0] == EdgeBlockWriter::BLOCK_MARKER) {
+        if (available < 2) {
+            return 0;
+        }
+        size_t payloadLength = block[1];
+        size_t blockLength = payloadLength + 7;
+        if (payloadLength > EdgeBlockWriter::MAX_PAYLOAD) {
+            skippedBytes++;
+            return 1;
+        }
+        if (available < blockLength) {
+            return 0;
+        }
+        if (checksum(block + 1, blockLength - 2) != block[blockLength - 1]) {
+            corruptBlocks++;
+            skippedBytes++;
+            return 1;
+        }
+        blockCount++;
+        decodeEvents(readU32(block + 2), block + 6, payloadLength);
+        return blockLength;
+    }
+
+    if (block[0] == EdgeBlockWriter::OVERRUN_MARKER) {
+        if (available < EdgeBlockWriter::OVERRUN_BLOCK_SIZE) {
+            return 0;
+        }
+        if (checksum(block + 1, 4) != block[5]) {
+            corruptBlocks++;
+            skippedBytes++;
+            return 1;
+        }
+        blockCount++;
+        if (overrunHandler) {
+            overrunHandler(handlerContext, readU32(block + 1));
+        }
+        return EdgeBlockWriter::OVERRUN_BLOCK_SIZE;
+    }
+
+    // Interleaved text logging or line noise
+    skippedBytes++;
+    return 1;
+}
+
+void EdgeStreamReader::decodeEvents(uint32_t timestamp, const uint8_t* payload, size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        uint8_t first = payload[i++];
+        uint32_t delta = (first >> 3) & 0x0F;
+        int shift = 4;
+        bool more = first & 0x80;
+        while (more && i < length && shift < 32) {
+            uint8_t next = payload[i++];
+            delta |= (uint32_t)(next & 0x7F) << shift;
+            shift += 7;
+            more = next & 0x80;
+        }
+
+        timestamp += delta;
+        if (eventHandler) {
+            I2CEdgeEvent event;
+            event.timestamp = timestamp;
+            event.lines = first & 0x07;
+            eventHandler(handlerContext, event);
+        }
+    }
+}
+
+unsigned long EdgeStreamReader::getBlockCount() const {
+    return blockCount;
+}
+
+unsigned long EdgeStreamReader::getCorruptBlockCount() const {
+    return corruptBlocks;
+}
+
+unsigned long EdgeStreamReader::getSkippedByteCount() const {
+    return skippedBytes;
+}
+
+uint8_t EdgeStreamReader::checksum(const uint8_t* data, size_t length) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < length; i++) {
+        sum ^= data[i];
+    }
+    return sum;
+}
+
+uint32_t EdgeStreamReader::readU32(const uint8_t* data) {
+    return (uint32_t)data[0] |
+           ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) |
+           ((uint32_t)data[3] << 24);
+}
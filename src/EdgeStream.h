@@ -0,0 +1,88 @@
+#ifndef EDGE_STREAM_H
+#define EDGE_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Raw SDA/SCL edge capture, packed into checksummed blocks so a host can
+// decode the bus offline when the on-device decoder is not trusted.
+//
+// Edge block:    0xED | len | base timestamp (u32 LE) | events[len] | xor
+// Overrun block: 0xEF | dropped edge count (u32 LE) | xor
+//
+// Each event is 1-6 bytes: bit 0 = SCL level, bit 1 = SDA level, bit 2 = edge
+// came from the SDA pin, bits 3-6 = low 4 bits of the microsecond delta since
+// the previous event, bit 7 = more delta bits follow as LEB128.
+
+enum EdgeLines {
+    EDGE_SCL = 0x01,
+    EDGE_SDA = 0x02,
+    EDGE_FROM_SDA = 0x04
+};
+
+struct I2CEdgeEvent {
+    uint32_t timestamp;
+    uint8_t lines;
+};
+
+class EdgeBlockWriter {
+public:
+    static const uint8_t BLOCK_MARKER = 0xED;
+    static const uint8_t OVERRUN_MARKER = 0xEF;
+    static const size_t MAX_PAYLOAD = 240;
+    static const size_t MAX_BLOCK_SIZE = MAX_PAYLOAD + 7;
+    static const size_t OVERRUN_BLOCK_SIZE = 6;
+
+private:
+    static const size_t MAX_EVENT_SIZE = 6;
+    static const size_t HEADER_SIZE = 6;
+
+    uint8_t buffer[MAX_BLOCK_SIZE];
+    size_t length;
+    uint32_t lastTimestamp;
+
+public:
+    EdgeBlockWriter();
+    void begin(uint32_t baseTimestamp);
+    bool append(const I2CEdgeEvent& event);  // false once the block is full
+    bool isEmpty() const;
+    size_t finish();
+    const uint8_t* data() const;
+
+    static size_t writeOverrun(uint32_t droppedEdges, uint8_t* out);
+};
+
+class EdgeStreamReader {
+public:
+    typedef void (*EventHandler)(void* context, const I2CEdgeEvent& event);
+    typedef void (*OverrunHandler)(void* context, uint32_t droppedEdges);
+
+private:
+    static const size_t BUFFER_SIZE = 2 * EdgeBlockWriter::MAX_BLOCK_SIZE;
+
+    EventHandler eventHandler;
+    OverrunHandler overrunHandler;
+    void* handlerContext;
+
+    uint8_t buffer[BUFFER_SIZE];
+    size_t bufferLength;
+    unsigned long blockCount;
+    unsigned long corruptBlocks;
+    unsigned long skippedBytes;
+
+public:
+    EdgeStreamReader();
+    void setHandlers(EventHandler onEvent, OverrunHandler onOverrun, void* context);
+    void feed(const uint8_t* data, size_t length);
+    unsigned long getBlockCount() const;
+    unsigned long getCorruptBlockCount() const;
+    unsigned long getSkippedByteCount() const;
+
+private:
+    size_t parseBlock(const uint8_t* block, size_t available);  // 0 = need more input
+    void decodeEvents(uint32_t timestamp, const uint8_t* payload, size_t length);
+    static uint8_t checksum(const uint8_t* data, size_t length);
+    static uint32_t readU32(const uint8_t* data);
+};
+
+#endif
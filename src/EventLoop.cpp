@@ -0,0 +1,61 @@
+#include "EventLoop.h"
+
+volatile TaskHandle_t EventLoop::loopTask = nullptr;
+
+EventLoop::EventLoop() : waitMillis(MAX_IDLE_MS) {
+}
+
+void EventLoop::begin() {
+    loopTask = xTaskGetCurrentTaskHandle();
+}
+
+void IRAM_ATTR EventLoop::signalFromISR(uint32_t events) {
+    TaskHandle_t task = loopTask;
+    if (!task) {
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(task, events, eSetBits, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void EventLoop::signal(uint32_t events) {
+    TaskHandle_t task = loopTask;
+    if (task) {
+        xTaskNotify(task, events, eSetBits);
+    }
+}
+
+unsigned long EventLoop::remaining(unsigned long since, unsigned long interval) {
+    unsigned long elapsed = millis() - since;
+    return elapsed >= interval ? 0 : interval - elapsed;
+}
+
+void EventLoop::wakeWithin(unsigned long milliseconds) {
+    if (milliseconds < waitMillis) {
+        waitMillis = milliseconds;
+    }
+}
+
+void EventLoop::wakeBy(unsigned long deadline) {
+    long left = (long)(deadline - millis());
+    wakeWithin(left > 0 ? left : 0);
+}
+
+uint32_t EventLoop::wait() {
+    // Events set since the last wait are still latched, so none is lost
+    // between a pass finding no work and blocking here
+    uint32_t events = 0;
+    TickType_t ticks = waitMillis == 0 ? 0 : pdMS_TO_TICKS(waitMillis);
+    if (ticks == 0 && waitMillis > 0) {
+        ticks = 1;
+    }
+    waitMillis = MAX_IDLE_MS;
+
+    if (xTaskNotifyWait(0, 0xFFFFFFFF, &events, ticks) != pdTRUE) {
+        return EVENT_DEADLINE;
+    }
+    return events;
+}
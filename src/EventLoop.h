@@ -0,0 +1,41 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Lets the Arduino loop task sleep until there is work. Interrupt handlers
+// and BLE callbacks set event bits on the task's notification value; every
+// pass also registers its nearest deadline, and wait() blocks until an event
+// arrives or that deadline passes. While blocked the idle task parks the CPU.
+class EventLoop {
+public:
+    enum Event : uint32_t {
+        EVENT_TRANSACTIONS = 0x01,  // A transaction queue went from empty to non-empty
+        EVENT_EDGES = 0x02,         // A raw edge ring reached EDGE_WAKE_THRESHOLD
+        EVENT_CONNECTION = 0x04,    // A BLE client connected or disconnected
+        EVENT_CONFIG = 0x08,        // A config write is waiting to be parsed
+        EVENT_DEADLINE = 0x80000000 // Set by wait() when it timed out
+    };
+
+    static const size_t EDGE_WAKE_THRESHOLD = 128;
+    static const unsigned long MAX_IDLE_MS = 1000;
+
+private:
+    static volatile TaskHandle_t loopTask;
+    unsigned long waitMillis;
+
+public:
+    EventLoop();
+    static void begin();  // Call from the task that will wait()
+    static void IRAM_ATTR signalFromISR(uint32_t events);
+    static void signal(uint32_t events);
+    static unsigned long remaining(unsigned long since, unsigned long interval);
+
+    void wakeWithin(unsigned long milliseconds);
+    void wakeBy(unsigned long deadline);
+    uint32_t wait();  // Returns the events that ended the wait
+};
+
+#endif
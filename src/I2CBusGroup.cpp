@@ -0,0 +1,92 @@
+#include "I2CBusGroup.h"
+
+I2CBusGroup::I2CBusGroup() : busCount(0) {
+    for (int i = 0; i < MAX_BUSES; i++) {
+        listeners[i] = nullptr;
+    }
+}
+
+I2CBusGroup::~I2CBusGroup() {
+    for (int i = 0; i < busCount; i++) {
+        delete listeners[i];
+    }
+}
+
+bool I2CBusGroup::addBus(int sdaPin, int sclPin) {
+    if (busCount >= MAX_BUSES) {
+        return false;
+    }
+
+    listeners[busCount] = new I2CListener(busCount, sdaPin, sclPin);
+    busCount++;
+    return true;
+}
+
+bool I2CBusGroup::begin() {
+    bool ok = true;
+    for (int i = 0; i < busCount; i++) {
+        ok = listeners[i]->begin() && ok;
+    }
+    return ok;
+}
+
+void I2CBusGroup::setDataCallback(I2CDataCallback callback) {
+    for (int i = 0; i < busCount; i++) {
+        listeners[i]->setDataCallback(callback);
+    }
+}
+
+void I2CBusGroup::setRawCallback(I2CRawCallback callback) {
+    for (int i = 0; i < busCount; i++) {
+        listeners[i]->setRawCallback(callback);
+    }
+}
+
+void I2CBusGroup::processI2C() {
+    // Merge the per-bus queues in timestamp order; all buses share micros()
+    for (int delivered = 0; delivered < MAX_MERGE_BATCH; delivered++) {
+        int oldest = -1;
+        unsigned long oldestTimestamp = 0;
+
+        for (int i = 0; i < busCount; i++) {
+            unsigned long timestamp;
+            if (!listeners[i]->peekTransaction(timestamp)) {
+                continue;
+            }
+            if (oldest < 0 || (int32_t)((uint32_t)timestamp - (uint32_t)oldestTimestamp) < 0) {
+                oldest = i;
+                oldestTimestamp = timestamp;
+            }
+        }
+
+        if (oldest < 0) {
+            break;
+        }
+        listeners[oldest]->deliverTransaction();
+    }
+
+    for (int i = 0; i < busCount; i++) {
+        listeners[i]->processRawEdges();
+    }
+}
+
+bool I2CBusGroup::hasPendingTransactions() {
+    for (int i = 0; i < busCount; i++) {
+        if (listeners[i]->hasPendingTransactions()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int I2CBusGroup::getBusCount() {
+    return busCount;
+}
+
+I2CListener& I2CBusGroup::getBus(int index) {
+    return *listeners[isValidBus(index) ? index : 0];
+}
+
+bool I2CBusGroup::isValidBus(int index) {
+    return index >= 0 && index < busCount;
+}
@@ -0,0 +1,38 @@
+#ifndef I2C_BUS_GROUP_H
+#define I2C_BUS_GROUP_H
+
+#include "I2CListener.h"
+
+struct I2CBusPins {
+    int sdaPin;
+    int sclPin;
+};
+
+// Owns one I2CListener per bus and merges their queued transactions, oldest
+// first, into a single callback. Each listener keeps its own decoder, queue
+// and filter, so the interrupt handlers of different buses share nothing.
+class I2CBusGroup {
+public:
+    static const int MAX_BUSES = 3;
+
+private:
+    static const int MAX_MERGE_BATCH = 64;  // Bounds one processI2C() call under load
+
+    I2CListener* listeners[MAX_BUSES];
+    int busCount;
+
+public:
+    I2CBusGroup();
+    ~I2CBusGroup();
+    bool addBus(int sdaPin, int sclPin);
+    bool begin();
+    void setDataCallback(I2CDataCallback callback);
+    void setRawCallback(I2CRawCallback callback);
+    void processI2C();
+    bool hasPendingTransactions();  // processI2C() delivers at most MAX_MERGE_BATCH
+    int getBusCount();
+    I2CListener& getBus(int index);
+    bool isValidBus(int index);
+};
+
+#endif
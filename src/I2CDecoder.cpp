@@ -0,0 +1,156 @@
+#include "I2CDecoder.h"
+
+I2CDecoder::I2CDecoder() :
+    transactionHandler(nullptr),
+    handlerContext(nullptr),
+    currentState(IDLE),
+    lastSDA(true),
+    lastSCL(true),
+    currentByte(0),
+    bitCount(0),
+    currentAddress(0),
+    isReadTransaction(false),
+    transactionStart(0),
+    dataIndex(0),
+    hasError(false),
+    lastEdgeTime(0) {
+}
+
+void I2CDecoder::setTransactionHandler(TransactionHandler handler, void* context) {
+    transactionHandler = handler;
+    handlerContext = context;
+}
+
+I2CState I2CDecoder::getState() const {
+    return currentState;
+}
+
+void IRAM_ATTR I2CDecoder::handleSCLEdge(bool sclState, bool sdaState, uint32_t timestampMicros) {
+    if (timestampMicros - lastEdgeTime < DEBOUNCE_MICROS) {
+        return;
+    }
+    lastEdgeTime = timestampMicros;
+
+    // SCL rising edge - data is stable, read the bit
+    if (sclState && !lastSCL) {
+        switch (currentState) {
+            case ADDRESS_BITS:
+                processBit(sdaState);
+                break;
+            case DATA_BITS:
+                processBit(sdaState);
+                break;
+            case ADDRESS_ACK:
+            case DATA_ACK:
+                processAck(sdaState);
+                break;
+            default:
+                break;
+        }
+    }
+
+    lastSCL = sclState;
+    lastSDA = sdaState;
+}
+
+void IRAM_ATTR I2CDecoder::handleSDAEdge(bool sclState, bool sdaState, uint32_t timestampMicros) {
+    if (timestampMicros - lastEdgeTime < DEBOUNCE_MICROS) {
+        return;
+    }
+    lastEdgeTime = timestampMicros;
+
+    // Only check for START/STOP when SCL is high
+    if (sclState) {
+        // START condition: SDA falls while SCL is high
+        if (!sdaState && lastSDA) {
+            // Repeated START ends the previous phase (e.g. register pointer write)
+            if (currentState != IDLE) {
+                completeTransaction(timestampMicros);
+            }
+            currentState = START_DETECTED;
+            transactionStart = timestampMicros;
+            currentByte = 0;
+            bitCount = 0;
+            dataIndex = 0;
+            hasError = false;
+            currentState = ADDRESS_BITS;
+        }
+        // STOP condition: SDA rises while SCL is high
+        else if (sdaState && !lastSDA) {
+            if (currentState != IDLE) {
+                completeTransaction(timestampMicros);
+            }
+            reset();
+        }
+    }
+
+    lastSCL = sclState;
+    lastSDA = sdaState;
+}
+
+void IRAM_ATTR I2CDecoder::completeTransaction(uint32_t endMicros) {
+    if (dataIndex == 0 || !transactionHandler) {
+        return;
+    }
+
+    I2CTransaction transaction;
+    transaction.address = currentAddress;
+    transaction.isRead = isReadTransaction;
+    transaction.data = dataBuffer;
+    transaction.dataLength = dataIndex;
+    transaction.timestamp = transactionStart;
+    transaction.endTimestamp = endMicros;
+    transaction.hasError = hasError;
+    transaction.busId = 0;
+
+    transactionHandler(handlerContext, transaction);
+}
+
+void IRAM_ATTR I2CDecoder::reset() {
+    currentState = IDLE;
+    currentByte = 0;
+    bitCount = 0;
+    currentAddress = 0;
+    isReadTransaction = false;
+    dataIndex = 0;
+    hasError = false;
+    lastSDA = true;
+    lastSCL = true;
+}
+
+void IRAM_ATTR I2CDecoder::processBit(bool bit) {
+    currentByte = (currentByte << 1) | (bit ? 1 : 0);
+    bitCount++;
+
+    if (bitCount == 8) {
+        if (currentState == ADDRESS_BITS) {
+            currentAddress = currentByte >> 1;  // Address is upper 7 bits
+            isReadTransaction = currentByte & 1; // R/W bit is LSB
+            currentState = ADDRESS_ACK;
+        } else if (currentState == DATA_BITS) {
+            if (dataIndex < MAX_DATA_SIZE) {
+                dataBuffer[dataIndex++] = currentByte;
+            }
+            currentState = DATA_ACK;
+        }
+        currentByte = 0;
+        bitCount = 0;
+    }
+}
+
+void IRAM_ATTR I2CDecoder::processAck(bool ack) {
+    if (!ack) {  // ACK is low
+        if (currentState == ADDRESS_ACK) {
+            currentState = DATA_BITS;
+        } else if (currentState == DATA_ACK) {
+            currentState = DATA_BITS;  // Continue reading data
+        }
+    } else {  // NACK is high
+        if (currentState == DATA_ACK) {
+            // NACK received, transaction ending
+            hasError = false;  // NACK is normal end of read transaction
+        } else {
+            hasError = true;   // Unexpected NACK
+        }
+    }
+}
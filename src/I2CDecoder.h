@@ -0,0 +1,82 @@
+#ifndef I2C_DECODER_H
+#define I2C_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+struct I2CTransaction {
+    uint8_t address;
+    bool isRead;
+    uint8_t* data;
+    size_t dataLength;
+    unsigned long timestamp;    // Microseconds at START
+    unsigned long endTimestamp; // Microseconds at STOP or repeated START
+    bool hasError;
+    uint8_t busId;
+};
+
+enum I2CState {
+    IDLE,
+    START_DETECTED,
+    ADDRESS_BITS,
+    ADDRESS_ACK,
+    DATA_BITS,
+    DATA_ACK,
+    STOP_DETECTED
+};
+
+// Hardware-independent I2C protocol decoder. Fed with line levels sampled on
+// each SCL/SDA edge, so the same logic runs in the firmware ISRs and in the
+// host tools that replay captured edge streams.
+class I2CDecoder {
+public:
+    typedef void (*TransactionHandler)(void* context, const I2CTransaction& transaction);
+
+    static const int MAX_DATA_SIZE = 32;
+    static const uint32_t DEBOUNCE_MICROS = 2;
+
+private:
+    TransactionHandler transactionHandler;
+    void* handlerContext;
+
+    // I2C Protocol State
+    volatile I2CState currentState;
+    volatile bool lastSDA;
+    volatile bool lastSCL;
+    volatile uint8_t currentByte;
+    volatile uint8_t bitCount;
+    volatile uint8_t currentAddress;
+    volatile bool isReadTransaction;
+    volatile uint32_t transactionStart;
+
+    // Data buffers
+    uint8_t dataBuffer[MAX_DATA_SIZE];
+    volatile size_t dataIndex;
+    volatile bool hasError;
+
+    // Timing for debouncing
+    volatile uint32_t lastEdgeTime;
+
+public:
+    I2CDecoder();
+    void setTransactionHandler(TransactionHandler handler, void* context);
+    void IRAM_ATTR reset();
+    void IRAM_ATTR handleSCLEdge(bool sclState, bool sdaState, uint32_t timestampMicros);
+    void IRAM_ATTR handleSDAEdge(bool sclState, bool sdaState, uint32_t timestampMicros);
+    I2CState getState() const;
+
+private:
+    void IRAM_ATTR processBit(bool bit);
+    void IRAM_ATTR processAck(bool ack);
+    void IRAM_ATTR completeTransaction(uint32_t endMicros);
+};
+
+#endif
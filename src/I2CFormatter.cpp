@@ -8,7 +8,9 @@ String I2CFormatter::formatTransaction(const I2CTransaction& transaction, I2CFor
         String output = "";
 
         output += formatTimestamp(transaction.timestamp);
-        output += " [0x";
+        output += " [";
+        output += formatBusPrefix(transaction.busId);
+        output += "0x";
         output += byteToHex(transaction.address);
         output += "] ";
 
@@ -23,10 +25,119 @@ String I2CFormatter::formatTransaction(const I2CTransaction& transaction, I2CFor
         return output;
     }
 
+String I2CFormatter::formatRegisterChanges(const I2CTransaction& transaction, const RegisterChange* changes, size_t count) {
+    String output = formatTimestamp(transaction.timestamp);
+    output += " [";
+    output += formatBusPrefix(transaction.busId);
+    output += "0x";
+    output += byteToHex(transaction.address);
+    output += "] REG:";
+
+    for (size_t i = 0; i < count; i++) {
+        output += " 0x";
+        output += byteToHex(changes[i].reg);
+        output += "=0x";
+        output += byteToHex(changes[i].value);
+    }
+
+    output += "\n";
+    return output;
+}
+
+String I2CFormatter::formatShadowSummary(uint8_t busId, const ShadowDeviceStats& stats, unsigned long timestamp) {
+    String output = formatTimestamp(timestamp);
+    output += " [";
+    output += formatBusPrefix(busId);
+    output += "0x";
+    output += byteToHex(stats.address);
+    output += "] SUMMARY: ";
+    output += String(stats.transactions) + " transactions, ";
+    output += String(stats.changes) + " changes, ";
+    output += String(stats.knownRegisters) + " registers\n";
+    return output;
+}
+
+String I2CFormatter::formatSuppressedSummary(uint8_t busId, const AddressRange& range, uint32_t count, unsigned long timestamp) {
+    String output = formatTimestamp(timestamp);
+    output += " [";
+    output += formatBusPrefix(busId);
+    output += "0x";
+    output += byteToHex(range.minAddress);
+    output += "-0x";
+    output += byteToHex(range.maxAddress);
+    output += "] SUPPRESSED: ";
+    output += String(count) + " transactions\n";
+    return output;
+}
+
+String I2CFormatter::formatDroppedSummary(uint8_t busId, uint32_t count, unsigned long timestamp, const char* stage) {
+    String output = formatTimestamp(timestamp);
+    output += " [";
+    output += formatBusPrefix(busId);
+    output += stage;
+    output += "] DROPPED: ";
+    output += String(count) + " transactions\n";
+    return output;
+}
+
+String I2CFormatter::formatDissectorRecord(const DissectorRecord& record) {
+    String output = formatTimestamp(record.timestamp);
+    output += " [";
+    output += formatBusPrefix(record.busId);
+    output += "0x";
+    output += byteToHex(record.address);
+    output += "] ";
+    output += record.dissector->name;
+    output += ":";
+
+    for (size_t i = 0; i < record.count; i++) {
+        const DissectorChannel& channel = record.dissector->channels[record.values[i].channel];
+        output += " ";
+        output += channel.name;
+        output += "=";
+        appendDissectorValue(output, channel, record.values[i].value);
+    }
+
+    if (record.check != CHECK_NONE) {
+        output += record.check == CHECK_OK ? " check=OK" : " check=FAILED";
+    }
+    output += "\n";
+    return output;
+}
+
+String I2CFormatter::formatDissectorWindow(const DissectorWindow& window) {
+    const DissectorChannel& channel = window.dissector->channels[window.channel];
+    String output = formatTimestamp(window.timestamp);
+    output += " [";
+    output += formatBusPrefix(window.busId);
+    output += "0x";
+    output += byteToHex(window.address);
+    output += "] ";
+    output += window.dissector->name;
+    output += " WINDOW: ";
+    output += channel.name;
+    output += " n=" + String(window.count) + " min=";
+    appendDissectorValue(output, channel, window.minValue);
+    output += " max=";
+    appendDissectorValue(output, channel, window.maxValue);
+    output += " mean=";
+    appendDissectorValue(output, channel, window.meanValue);
+    output += "\n";
+    return output;
+}
+
 String I2CFormatter::formatTimestamp(unsigned long timestamp) {
     return String(timestamp);
 }
 
+String I2CFormatter::formatBusPrefix(uint8_t busId) {
+    // Bus 0 keeps the single-bus format; other buses are tagged "<bus>:"
+    if (busId == 0) {
+        return "";
+    }
+    return String(busId) + ":";
+}
+
 String I2CFormatter::byteToHex(uint8_t value) {
     String hex = String(value, HEX);
     if (hex.length() == 1) {
@@ -44,6 +155,24 @@ String I2CFormatter::byteToBinary(uint8_t value) {
     return bin;
 }
 
+void I2CFormatter::appendDissectorValue(String& str, const DissectorChannel& channel, int32_t value) {
+    if (channel.hex) {
+        snprintf(outputBuffer, MAX_OUTPUT_SIZE, "0x%02lX", (unsigned long)(uint32_t)value);
+    } else if (channel.decimals == 0) {
+        snprintf(outputBuffer, MAX_OUTPUT_SIZE, "%ld%s", (long)value, channel.unit);
+    } else {
+        // Fixed point: value / 10^decimals
+        uint32_t scale = 1;
+        for (uint8_t i = 0; i < channel.decimals; i++) {
+            scale *= 10;
+        }
+        uint32_t magnitude = value < 0 ? -(int64_t)value : value;
+        snprintf(outputBuffer, MAX_OUTPUT_SIZE, "%s%lu.%0*lu%s", value < 0 ? "-" : "",
+                 (unsigned long)(magnitude / scale), channel.decimals, (unsigned long)(magnitude % scale), channel.unit);
+    }
+    str += outputBuffer;
+}
+
 void I2CFormatter::appendDataToString(String& str, const I2CTransaction& transaction, I2CFormatterType kind) {
     if (transaction.data == nullptr || transaction.dataLength == 0) {
         str += "ACK";
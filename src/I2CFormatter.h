@@ -2,6 +2,7 @@
 #define I2C_FORMATTER_H
 
 #include "I2CListener.h"
+#include "Dissector.h"
 #include <String.h>
 
 enum I2CFormatterType {
@@ -10,6 +11,16 @@ enum I2CFormatterType {
     Decimal
 };
 
+enum SerialOutputMode {
+    SERIAL_TEXT,    // Human-readable lines
+    SERIAL_BINARY   // COBS-framed BinaryFrame records
+};
+
+struct OutputSettings {
+    SerialOutputMode serialMode;
+    I2CFormatterType dataFormat;
+};
+
 class I2CFormatter {
 private:
     static const size_t MAX_OUTPUT_SIZE = 256;
@@ -18,12 +29,20 @@ private:
 public:
     I2CFormatter();
     String formatTransaction(const I2CTransaction& transaction, I2CFormatterType kind = I2CFormatterType::Binary);
+    String formatRegisterChanges(const I2CTransaction& transaction, const RegisterChange* changes, size_t count);
+    String formatShadowSummary(uint8_t busId, const ShadowDeviceStats& stats, unsigned long timestamp);
+    String formatSuppressedSummary(uint8_t busId, const AddressRange& range, uint32_t count, unsigned long timestamp);
+    String formatDroppedSummary(uint8_t busId, uint32_t count, unsigned long timestamp, const char* stage = "QUEUE");
+    String formatDissectorRecord(const DissectorRecord& record);
+    String formatDissectorWindow(const DissectorWindow& window);
     String formatTimestamp(unsigned long timestamp);
 
 private:
+    String formatBusPrefix(uint8_t busId);
     String byteToHex(uint8_t value);
     String byteToBinary(uint8_t value);
     void appendDataToString(String& str, const I2CTransaction& transaction, I2CFormatterType kind = I2CFormatterType::Hex);
+    void appendDissectorValue(String& str, const DissectorChannel& channel, int32_t value);
 };
 
 #endif
@@ -1,41 +1,49 @@
 #include "I2CListener.h"
 
-// Static instance pointer for interrupt handlers
-I2CListener* I2CListener::instance = nullptr;
-
-I2CListener::I2CListener() : 
+I2CListener::I2CListener(uint8_t busId, int sdaPin, int sclPin) : 
+    busId(busId),
+    sdaPin(sdaPin),
+    sclPin(sclPin),
     addressFilter(),
+    registerShadow(),
     dataCallback(nullptr),
+    rawCallback(nullptr),
     isInitialized(false),
-    currentState(IDLE),
-    lastSDA(true),
-    lastSCL(true),
-    currentByte(0),
-    bitCount(0),
-    currentAddress(0),
-    isReadTransaction(false),
-    transactionStart(0),
-    dataIndex(0),
-    hasError(false),
-    lastEdgeTime(0) {
-    instance = this;
+    captureStartMicros(0),
+    decoder(),
+    captureMode(CAPTURE_DECODE),
+    queueHead(0),
+    queueTail(0),
+    droppedTransactions(0),
+    capturedTransactions(0),
+    peakQueueDepth(0),
+    edgeHead(0),
+    edgeTail(0),
+    droppedEdges(0),
+    reportedDroppedEdges(0),
+    overrunPending(false),
+    overrunAt(0),
+    blockWriter() {
+    decoder.setTransactionHandler(onDecodedTransaction, this);
 }
 
 bool I2CListener::begin() {
     // Configure pins as inputs with pull-ups (passive listening only)
-    pinMode(SDA_PIN, INPUT_PULLUP);
-    pinMode(SCL_PIN, INPUT_PULLUP);
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, INPUT_PULLUP);
     
     // Initialize state
-    resetState();
+    decoder.reset();
     
-    // Attach interrupts for both edges on both pins
-    attachInterrupt(digitalPinToInterrupt(SCL_PIN), sclInterrupt, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(SDA_PIN), sdaInterrupt, CHANGE);
+    // Attach interrupts for both edges on both pins; each bus gets its own
+    // handler argument so listeners never share interrupt-side state
+    attachInterruptArg(digitalPinToInterrupt(sclPin), sclInterrupt, this, CHANGE);
+    attachInterruptArg(digitalPinToInterrupt(sdaPin), sdaInterrupt, this, CHANGE);
+    captureStartMicros = micros();
     
     isInitialized = true;
     Serial.println("[I2C] Passive sniffer initialized - listening only, never writes to bus");
-    Serial.printf("[I2C] SDA: GPIO%d, SCL: GPIO%d\n", SDA_PIN, SCL_PIN);
+    Serial.printf("[I2C] Bus %d - SDA: GPIO%d, SCL: GPIO%d\n", busId, sdaPin, sclPin);
     
     return true;
 }
@@ -44,156 +52,257 @@ void I2CListener::setDataCallback(I2CDataCallback callback) {
     dataCallback = callback;
 }
 
+void I2CListener::setRawCallback(I2CRawCallback callback) {
+    rawCallback = callback;
+}
+
 AddressFilter& I2CListener::getAddressFilter() {
     return addressFilter;
 }
 
+RegisterShadow& I2CListener::getRegisterShadow() {
+    return registerShadow;
+}
+
+void I2CListener::setCaptureMode(I2CCaptureMode mode) {
+    if (mode == captureMode) {
+        return;
+    }
+    
+    noInterrupts();
+    // Start both paths from a clean slate so stale edges never reach the decoder
+    // and drops from the previous mode never turn into an overrun block
+    decoder.reset();
+    edgeTail = edgeHead;
+    overrunAt = edgeHead;
+    overrunPending = false;
+    reportedDroppedEdges = droppedEdges;
+    captureMode = mode;
+    interrupts();
+    
+    Serial.printf("[I2C] Capture mode: %s\n", mode == CAPTURE_DECODE ? "decode" : "raw edges");
+}
+
+I2CCaptureMode I2CListener::getCaptureMode() {
+    return captureMode;
+}
+
+uint32_t I2CListener::getDroppedEdgeCount() {
+    return droppedEdges;
+}
+
+uint32_t I2CListener::getDroppedTransactionCount() {
+    return droppedTransactions;
+}
+
+uint32_t I2CListener::getCapturedTransactionCount() {
+    return capturedTransactions;
+}
+
+size_t I2CListener::getQueueDepth() {
+    return (queueHead + MAX_TRANSACTIONS - queueTail) % MAX_TRANSACTIONS;
+}
+
+size_t I2CListener::getPeakQueueDepth() {
+    return peakQueueDepth;
+}
+
+size_t I2CListener::getQueueCapacity() {
+    return MAX_TRANSACTIONS - 1;
+}
+
+bool I2CListener::hasPendingTransactions() {
+    return queueTail != queueHead;
+}
+
+size_t I2CListener::getEdgeBacklog() {
+    return (edgeHead + EDGE_RING_SIZE - edgeTail) & (EDGE_RING_SIZE - 1);
+}
+
+uint8_t I2CListener::getBusId() {
+    return busId;
+}
+
+int I2CListener::getSDAPin() {
+    return sdaPin;
+}
+
+int I2CListener::getSCLPin() {
+    return sclPin;
+}
+
+uint32_t I2CListener::getCaptureStartMicros() {
+    return captureStartMicros;
+}
+
 void I2CListener::processI2C() {
-    // Non-interrupt processing can be done here if needed
-    // For now, everything is handled in interrupts
+    // Formatting and output happen here, never in interrupt context
+    drainTransactions();
+    processRawEdges();
 }
 
 // Static interrupt handlers
-void IRAM_ATTR I2CListener::sclInterrupt() {
-    if (instance) {
-        instance->handleSCLEdge();
-    }
+void IRAM_ATTR I2CListener::sclInterrupt(void* arg) {
+    static_cast<I2CListener*>(arg)->handleSCLEdge();
 }
 
-void IRAM_ATTR I2CListener::sdaInterrupt() {
-    if (instance) {
-        instance->handleSDAEdge();
-    }
+void IRAM_ATTR I2CListener::sdaInterrupt(void* arg) {
+    static_cast<I2CListener*>(arg)->handleSDAEdge();
+}
+
+void IRAM_ATTR I2CListener::onDecodedTransaction(void* context, const I2CTransaction& transaction) {
+    static_cast<I2CListener*>(context)->handleTransaction(transaction);
 }
 
 void IRAM_ATTR I2CListener::handleSCLEdge() {
-    unsigned long currentTime = micros();
-    if (currentTime - lastEdgeTime < DEBOUNCE_MICROS) {
-        return;
-    }
-    lastEdgeTime = currentTime;
+    bool sclState = readSCL();
+    bool sdaState = readSDA();
     
+    if (captureMode == CAPTURE_DECODE) {
+        decoder.handleSCLEdge(sclState, sdaState, micros());
+    } else {
+        recordEdge(sclState, sdaState, false);
+    }
+}
+
+void IRAM_ATTR I2CListener::handleSDAEdge() {
     bool sclState = readSCL();
     bool sdaState = readSDA();
     
-    // SCL rising edge - data is stable, read the bit
-    if (sclState && !lastSCL) {
-        switch (currentState) {
-            case ADDRESS_BITS:
-                processBit(sdaState);
-                break;
-            case DATA_BITS:
-                processBit(sdaState);
-                break;
-            case ADDRESS_ACK:
-            case DATA_ACK:
-                processAck(sdaState);
-                break;
+    if (captureMode == CAPTURE_DECODE) {
+        decoder.handleSDAEdge(sclState, sdaState, micros());
+    } else {
+        recordEdge(sclState, sdaState, true);
+    }
+}
+
+void IRAM_ATTR I2CListener::recordEdge(bool sclState, bool sdaState, bool fromSDA) {
+    size_t next = (edgeHead + 1) & (EDGE_RING_SIZE - 1);
+    if (next == edgeTail) {
+        // Latch where the gap is so the overrun block goes out after the
+        // edges captured before it, not ahead of them
+        if (!overrunPending) {
+            overrunAt = edgeHead;
+            overrunPending = true;
         }
+        droppedEdges++;
+        return;
     }
     
-    lastSCL = sclState;
-    lastSDA = sdaState;
+    I2CEdgeEvent& event = edgeRing[edgeHead];
+    event.timestamp = micros();
+    event.lines = (sclState ? EDGE_SCL : 0) |
+                  (sdaState ? EDGE_SDA : 0) |
+                  (fromSDA ? EDGE_FROM_SDA : 0);
+    edgeHead = next;
+
+    // Waking per edge would cost more than the edges; smaller backlogs are
+    // picked up by the loop's raw flush deadline
+    if (((next - edgeTail) & (EDGE_RING_SIZE - 1)) == EventLoop::EDGE_WAKE_THRESHOLD) {
+        EventLoop::signalFromISR(EventLoop::EVENT_EDGES);
+    }
 }
 
-void IRAM_ATTR I2CListener::handleSDAEdge() {
-    unsigned long currentTime = micros();
-    if (currentTime - lastEdgeTime < DEBOUNCE_MICROS) {
+void I2CListener::processRawEdges() {
+    if (captureMode == CAPTURE_DECODE) {
+        return;
+    }
+    if (!rawCallback) {
+        noInterrupts();
+        edgeTail = edgeHead;
+        overrunAt = edgeHead;
+        overrunPending = false;
+        reportedDroppedEdges = droppedEdges;
+        interrupts();
         return;
     }
-    lastEdgeTime = currentTime;
-    
-    bool sclState = readSCL();
-    bool sdaState = readSDA();
     
-    // Only check for START/STOP when SCL is high
-    if (sclState) {
-        // START condition: SDA falls while SCL is high
-        if (!sdaState && lastSDA) {
-            currentState = START_DETECTED;
-            transactionStart = millis();
-            currentByte = 0;
-            bitCount = 0;
-            dataIndex = 0;
-            hasError = false;
-            currentState = ADDRESS_BITS;
-        }
-        // STOP condition: SDA rises while SCL is high
-        else if (sdaState && !lastSDA) {
-            if (currentState != IDLE) {
-                // Complete transaction
-                if (dataIndex > 0 && addressFilter.isAddressAllowed(currentAddress)) {
-                    handleTransaction(currentAddress, isReadTransaction, 
-                                   const_cast<uint8_t*>(dataBuffer), dataIndex, hasError);
-                }
-            }
-            resetState();
-        }
+    if (overrunPending) {
+        sendEdgeBlocks(overrunAt);
+        
+        noInterrupts();
+        uint32_t dropped = droppedEdges;
+        overrunPending = false;
+        interrupts();
+        
+        uint8_t overrun[EdgeBlockWriter::OVERRUN_BLOCK_SIZE];
+        size_t length = EdgeBlockWriter::writeOverrun(dropped - reportedDroppedEdges, overrun);
+        rawCallback(busId, overrun, length);
+        reportedDroppedEdges = dropped;
     }
     
-    lastSCL = sclState;
-    lastSDA = sdaState;
+    // A drop latched after this head read lies at or beyond it, so stopping
+    // at the head never crosses a gap
+    size_t head = edgeHead;
+    sendEdgeBlocks(overrunPending ? overrunAt : head);
 }
 
-void IRAM_ATTR I2CListener::resetState() {
-    currentState = IDLE;
-    currentByte = 0;
-    bitCount = 0;
-    currentAddress = 0;
-    isReadTransaction = false;
-    dataIndex = 0;
-    hasError = false;
-    lastSDA = true;
-    lastSCL = true;
+void I2CListener::sendEdgeBlocks(size_t stop) {
+    size_t tail = edgeTail;
+    while (tail != stop) {
+        blockWriter.begin(edgeRing[tail].timestamp);
+        while (tail != stop && blockWriter.append(edgeRing[tail])) {
+            tail = (tail + 1) & (EDGE_RING_SIZE - 1);
+        }
+        // Release the slots before the (slow) output so the ISR can reuse them
+        edgeTail = tail;
+        size_t length = blockWriter.finish();
+        rawCallback(busId, blockWriter.data(), length);
+    }
 }
 
-void IRAM_ATTR I2CListener::processBit(bool bit) {
-    currentByte = (currentByte << 1) | (bit ? 1 : 0);
-    bitCount++;
+void IRAM_ATTR I2CListener::handleTransaction(const I2CTransaction& transaction) {
+    // Sampling runs before queueing so a chatty device cannot crowd out the rest
+    if (!dataCallback || !addressFilter.admit(transaction.address, transaction.timestamp)) {
+        return;
+    }
     
-    if (bitCount == 8) {
-        if (currentState == ADDRESS_BITS) {
-            currentAddress = currentByte >> 1;  // Address is upper 7 bits
-            isReadTransaction = currentByte & 1; // R/W bit is LSB
-            currentState = ADDRESS_ACK;
-        } else if (currentState == DATA_BITS) {
-            if (dataIndex < MAX_DATA_SIZE) {
-                dataBuffer[dataIndex++] = currentByte;
-            }
-            currentState = DATA_ACK;
-        }
-        currentByte = 0;
-        bitCount = 0;
+    size_t next = (queueHead + 1) % MAX_TRANSACTIONS;
+    if (next == queueTail) {
+        droppedTransactions++;
+        return;
+    }
+    
+    QueuedTransaction& entry = transactionQueue[queueHead];
+    entry.transaction = transaction;
+    entry.transaction.busId = busId;
+    memcpy(entry.data, transaction.data, transaction.dataLength);
+    queueHead = next;
+    capturedTransactions++;
+
+    size_t depth = (next + MAX_TRANSACTIONS - queueTail) % MAX_TRANSACTIONS;
+    if (depth > peakQueueDepth) {
+        peakQueueDepth = depth;
+    }
+
+    // The loop drains every queue before it sleeps, so only the first
+    // transaction after a drain needs to wake it
+    if (depth == 1) {
+        EventLoop::signalFromISR(EventLoop::EVENT_TRANSACTIONS);
     }
 }
 
-void IRAM_ATTR I2CListener::processAck(bool ack) {
-    if (!ack) {  // ACK is low
-        if (currentState == ADDRESS_ACK) {
-            currentState = DATA_BITS;
-        } else if (currentState == DATA_ACK) {
-            currentState = DATA_BITS;  // Continue reading data
-        }
-    } else {  // NACK is high
-        if (currentState == DATA_ACK) {
-            // NACK received, transaction ending
-            hasError = false;  // NACK is normal end of read transaction
-        } else {
-            hasError = true;   // Unexpected NACK
-        }
+bool I2CListener::peekTransaction(unsigned long& timestamp) {
+    if (queueTail == queueHead) {
+        return false;
     }
+    timestamp = transactionQueue[queueTail].transaction.timestamp;
+    return true;
 }
 
-void I2CListener::handleTransaction(uint8_t address, bool isRead, uint8_t* data, size_t length, bool hasError) {
-    if (dataCallback && addressFilter.isAddressAllowed(address)) {
-        I2CTransaction transaction;
-        transaction.address = address;
-        transaction.isRead = isRead;
-        transaction.data = data;
-        transaction.dataLength = length;
-        transaction.timestamp = transactionStart;
-        transaction.hasError = hasError;
-        
-        dataCallback(transaction);
+void I2CListener::deliverTransaction() {
+    if (queueTail == queueHead) {
+        return;
     }
-}
\ No newline at end of file
+    QueuedTransaction& entry = transactionQueue[queueTail];
+    entry.transaction.data = entry.data;
+    dataCallback(entry.transaction);
+    queueTail = (queueTail + 1) % MAX_TRANSACTIONS;
+}
+
+void I2CListener::drainTransactions() {
+    size_t head = queueHead;
+    while (queueTail != head) {
+        deliverTransaction();
+    }
+}
@@ -4,79 +4,104 @@
 #include <functional>
 #include <Arduino.h>
 #include "AddressFilter.h"
-
-struct I2CTransaction {
-    uint8_t address;
-    bool isRead;
-    uint8_t* data;
-    size_t dataLength;
-    unsigned long timestamp;
-    bool hasError;
-};
+#include "I2CDecoder.h"
+#include "EdgeStream.h"
+#include "EventLoop.h"
+#include "RegisterShadow.h"
 
 typedef std::function<void(const I2CTransaction&)> I2CDataCallback;
+typedef std::function<void(uint8_t busId, const uint8_t*, size_t)> I2CRawCallback;
 
-enum I2CState {
-    IDLE,
-    START_DETECTED,
-    ADDRESS_BITS,
-    ADDRESS_ACK,
-    DATA_BITS,
-    DATA_ACK,
-    STOP_DETECTED
+enum I2CCaptureMode {
+    CAPTURE_DECODE,      // Decode on device and report transactions
+    CAPTURE_RAW_SERIAL,  // Stream raw edge blocks over USB serial
+    CAPTURE_RAW_BLE      // Stream raw edge blocks over USB serial and BLE
 };
 
 class I2CListener {
+public:
+    static const int DEFAULT_SDA_PIN = 4;
+    static const int DEFAULT_SCL_PIN = 5;
+
 private:
-    static const int SDA_PIN = 4;
-    static const int SCL_PIN = 5;
-    static const int MAX_DATA_SIZE = 32;
     static const int MAX_TRANSACTIONS = 16;
+    static const size_t EDGE_RING_SIZE = 1024;  // Must be a power of two
     
+    uint8_t busId;
+    int sdaPin;
+    int sclPin;
     AddressFilter addressFilter;
+    RegisterShadow registerShadow;
     I2CDataCallback dataCallback;
+    I2CRawCallback rawCallback;
     bool isInitialized;
+    uint32_t captureStartMicros;
     
-    // I2C Protocol State
-    volatile I2CState currentState;
-    volatile bool lastSDA;
-    volatile bool lastSCL;
-    volatile uint8_t currentByte;
-    volatile uint8_t bitCount;
-    volatile uint8_t currentAddress;
-    volatile bool isReadTransaction;
-    volatile unsigned long transactionStart;
+    I2CDecoder decoder;
+    volatile I2CCaptureMode captureMode;
     
-    // Data buffers
-    uint8_t dataBuffer[MAX_DATA_SIZE];
-    volatile size_t dataIndex;
-    volatile bool hasError;
+    // Decoded transactions, queued by the ISRs and delivered by processI2C()
+    struct QueuedTransaction {
+        I2CTransaction transaction;
+        uint8_t data[I2CDecoder::MAX_DATA_SIZE];
+    };
+    QueuedTransaction transactionQueue[MAX_TRANSACTIONS];
+    volatile size_t queueHead;
+    volatile size_t queueTail;
+    volatile uint32_t droppedTransactions;
+    volatile uint32_t capturedTransactions;
+    volatile size_t peakQueueDepth;
     
-    // Timing for debouncing
-    volatile unsigned long lastEdgeTime;
-    static const unsigned long DEBOUNCE_MICROS = 2;
+    // Raw edge capture, filled by the ISRs and drained by processI2C()
+    I2CEdgeEvent edgeRing[EDGE_RING_SIZE];
+    volatile size_t edgeHead;
+    volatile size_t edgeTail;
+    volatile uint32_t droppedEdges;
+    uint32_t reportedDroppedEdges;
+    volatile bool overrunPending;
+    volatile size_t overrunAt;      // Ring index of the first edge after the gap
+    EdgeBlockWriter blockWriter;
     
 public:
-    I2CListener();
+    I2CListener(uint8_t busId = 0, int sdaPin = DEFAULT_SDA_PIN, int sclPin = DEFAULT_SCL_PIN);
     bool begin();
     void setDataCallback(I2CDataCallback callback);
+    void setRawCallback(I2CRawCallback callback);
     void processI2C();  // Call this regularly from main loop instead of scanBus
+    void processRawEdges();
+    bool peekTransaction(unsigned long& timestamp);
+    void deliverTransaction();
+    uint8_t getBusId();
+    int getSDAPin();
+    int getSCLPin();
     AddressFilter& getAddressFilter();
+    RegisterShadow& getRegisterShadow();
+    void setCaptureMode(I2CCaptureMode mode);
+    I2CCaptureMode getCaptureMode();
+    uint32_t getDroppedEdgeCount();
+    uint32_t getDroppedTransactionCount();
+    uint32_t getCapturedTransactionCount();
+    size_t getQueueDepth();
+    size_t getPeakQueueDepth();     // Highest depth since boot
+    size_t getQueueCapacity();
+    size_t getEdgeBacklog();
+    bool hasPendingTransactions();
+    uint32_t getCaptureStartMicros();  // Time since boot when capture began
     
 private:
-    static void IRAM_ATTR sclInterrupt();
-    static void IRAM_ATTR sdaInterrupt();
-    static I2CListener* instance;
+    static void IRAM_ATTR sclInterrupt(void* arg);
+    static void IRAM_ATTR sdaInterrupt(void* arg);
+    static void IRAM_ATTR onDecodedTransaction(void* context, const I2CTransaction& transaction);
     
     void IRAM_ATTR handleSCLEdge();
     void IRAM_ATTR handleSDAEdge();
-    void IRAM_ATTR resetState();
-    void IRAM_ATTR processBit(bool bit);
-    void IRAM_ATTR processAck(bool ack);
-    void handleTransaction(uint8_t address, bool isRead, uint8_t* data, size_t length, bool hasError);
+    void IRAM_ATTR recordEdge(bool sclState, bool sdaState, bool fromSDA);
+    void IRAM_ATTR handleTransaction(const I2CTransaction& transaction);
+    void sendEdgeBlocks(size_t stop);
+    void drainTransactions();
     
-    inline bool readSDA() { return digitalRead(SDA_PIN); }
-    inline bool readSCL() { return digitalRead(SCL_PIN); }
+    inline bool readSDA() { return digitalRead(sdaPin); }
+    inline bool readSCL() { return digitalRead(sclPin); }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,127 @@
+#include "RegisterShadow.h"
+#include <string.h>
+
+RegisterShadow::RegisterShadow() : deviceCount(0), diffMode(false) {
+    clear();
+}
+
+bool RegisterShadow::apply(const I2CTransaction& transaction, RegisterChange* changes, size_t maxChanges, size_t& changeCount) {
+    changeCount = 0;
+
+    if (transaction.hasError || transaction.data == nullptr || transaction.dataLength == 0) {
+        return false;
+    }
+
+    ShadowDevice* device = findOrCreate(transaction.address);
+    if (!device) {
+        return false;
+    }
+
+    size_t start = 0;
+    if (!transaction.isRead) {
+        // First written byte is the register pointer
+        device->pointer = transaction.data[0];
+        device->pointerValid = true;
+        start = 1;
+    } else if (!device->pointerValid) {
+        // Read without a known pointer cannot be placed in the map
+        return false;
+    }
+
+    device->transactions++;
+
+    for (size_t i = start; i < transaction.dataLength; i++) {
+        uint8_t reg = device->pointer++;
+        uint8_t value = transaction.data[i];
+        bool known = isKnown(*device, reg);
+
+        if (known && device->values[reg] == value) {
+            continue;
+        }
+
+        device->values[reg] = value;
+        device->known[reg / 8] |= 1 << (reg % 8);
+        device->changes++;
+
+        if (changeCount < maxChanges) {
+            changes[changeCount].address = transaction.address;
+            changes[changeCount].reg = reg;
+            changes[changeCount].value = value;
+            changes[changeCount].firstSeen = !known;
+            changeCount++;
+        }
+    }
+
+    return true;
+}
+
+void RegisterShadow::clear() {
+    deviceCount = 0;
+    memset(devices, 0, sizeof(devices));
+}
+
+void RegisterShadow::setDiffMode(bool enabled) {
+    diffMode = enabled;
+}
+
+bool RegisterShadow::isDiffMode() {
+    return diffMode;
+}
+
+int RegisterShadow::getDeviceCount() {
+    return deviceCount;
+}
+
+ShadowDeviceStats RegisterShadow::getDeviceStats(int index) {
+    ShadowDeviceStats stats = {0, 0, 0, 0};
+    if (index < 0 || index >= deviceCount) {
+        return stats;
+    }
+
+    const ShadowDevice& device = devices[index];
+    stats.address = device.address;
+    stats.transactions = device.transactions;
+    stats.changes = device.changes;
+    for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+        if (isKnown(device, reg)) {
+            stats.knownRegisters++;
+        }
+    }
+    return stats;
+}
+
+void RegisterShadow::resetDeviceStats() {
+    for (int i = 0; i < deviceCount; i++) {
+        devices[i].transactions = 0;
+        devices[i].changes = 0;
+    }
+}
+
+bool RegisterShadow::getRegister(int index, uint8_t reg, uint8_t& value) {
+    if (index < 0 || index >= deviceCount || !isKnown(devices[index], reg)) {
+        return false;
+    }
+    value = devices[index].values[reg];
+    return true;
+}
+
+RegisterShadow::ShadowDevice* RegisterShadow::findOrCreate(uint8_t address) {
+    for (int i = 0; i < deviceCount; i++) {
+        if (devices[i].address == address) {
+            return &devices[i];
+        }
+    }
+
+    if (deviceCount >= MAX_DEVICES) {
+        return nullptr;
+    }
+
+    ShadowDevice* device = &devices[deviceCount++];
+    memset(device, 0, sizeof(ShadowDevice));
+    device->address = address;
+    return device;
+}
+
+bool RegisterShadow::isKnown(const ShadowDevice& device, uint8_t reg) {
+    return device.known[reg / 8] & (1 << (reg % 8));
+}
@@ -0,0 +1,63 @@
+#ifndef REGISTER_SHADOW_H
+#define REGISTER_SHADOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I2CDecoder.h"
+
+// Per-address mirror of device registers, rebuilt from bus traffic. The
+// register pointer is taken from the first byte of each write phase and
+// auto-increments across written and read bytes, as on most sensors.
+struct RegisterChange {
+    uint8_t address;
+    uint8_t reg;
+    uint8_t value;
+    bool firstSeen;
+};
+
+struct ShadowDeviceStats {
+    uint8_t address;
+    unsigned long transactions;
+    unsigned long changes;
+    int knownRegisters;
+};
+
+class RegisterShadow {
+public:
+    static const int MAX_DEVICES = 8;
+    static const int REGISTER_COUNT = 256;
+
+private:
+    struct ShadowDevice {
+        uint8_t address;
+        bool pointerValid;
+        uint8_t pointer;
+        uint8_t known[REGISTER_COUNT / 8];
+        uint8_t values[REGISTER_COUNT];
+        unsigned long transactions;
+        unsigned long changes;
+    };
+
+    ShadowDevice devices[MAX_DEVICES];
+    int deviceCount;
+    bool diffMode;
+
+public:
+    RegisterShadow();
+    // Returns false when the transaction could not be mirrored (device table
+    // full, bus error, or a read before any register pointer was seen)
+    bool apply(const I2CTransaction& transaction, RegisterChange* changes, size_t maxChanges, size_t& changeCount);
+    void clear();
+    void setDiffMode(bool enabled);
+    bool isDiffMode();
+    int getDeviceCount();
+    ShadowDeviceStats getDeviceStats(int index);
+    void resetDeviceStats();
+    bool getRegister(int index, uint8_t reg, uint8_t& value);
+
+private:
+    ShadowDevice* findOrCreate(uint8_t address);
+    bool isKnown(const ShadowDevice& device, uint8_t reg);
+};
+
+#endif
@@ -0,0 +1,228 @@
+#include "Dissector.h"
+
+// Compile-time dissector registry. Build with -DDISSECTOR_<NAME>=0 to drop a
+// dissector; its decoder and channel table are then never compiled.
+#ifndef DISSECTOR_SMBUS
+#define DISSECTOR_SMBUS 1
+#endif
+#ifndef DISSECTOR_TMP102
+#define DISSECTOR_TMP102 1
+#endif
+#ifndef DISSECTOR_LM75
+#define DISSECTOR_LM75 1
+#endif
+#ifndef DISSECTOR_MPU6050
+#define DISSECTOR_MPU6050 1
+#endif
+
+static int16_t readBigEndian16(const uint8_t* data) {
+    return (int16_t)((data[0] << 8) | data[1]);
+}
+
+// Register-map devices: a write sets the pointer, a pointer-only write just
+// sets up the following read
+static bool trackPointer(DissectorState& state, const I2CTransaction& transaction) {
+    if (transaction.isRead) {
+        return false;
+    }
+    state.pointer = transaction.data[0];
+    state.pointerValid = true;
+    return true;
+}
+
+#if DISSECTOR_SMBUS
+// SMBus with Packet Error Checking. Every write of two or more bytes ends in
+// a PEC byte; a one-byte write is the command phase of the read that follows
+// after a repeated START, and is covered by that read's PEC.
+static const DissectorChannel SMBUS_CHANNELS[] = {
+    {"cmd", "", 0, true},
+    {"data", "", 0, true},
+};
+
+static uint8_t smbusCrc8(uint8_t crc, uint8_t byte) {
+    crc ^= byte;
+    for (int bit = 0; bit < 8; bit++) {
+        crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+static int decodeSmbus(DissectorState& state, const I2CTransaction& transaction,
+                       DissectorValue* values, DissectorCheck& check) {
+    const uint8_t* data = transaction.data;
+    size_t length = transaction.dataLength;
+    uint8_t writeAddress = transaction.address << 1;
+
+    if (!transaction.isRead && length == 1) {
+        state.lastWrite[0] = data[0];
+        state.lastWriteLength = 1;
+        return 0;
+    }
+    if (length < 2) {
+        state.lastWriteLength = 0;
+        return -1;
+    }
+
+    uint8_t crc = 0;
+    int count = 0;
+    size_t payload = 0;
+    if (transaction.isRead) {
+        if (state.lastWriteLength == 1) {
+            crc = smbusCrc8(crc, writeAddress);
+            crc = smbusCrc8(crc, state.lastWrite[0]);
+            values[count++] = {0, state.lastWrite[0]};
+        }
+        crc = smbusCrc8(crc, writeAddress | 1);
+    } else {
+        crc = smbusCrc8(crc, writeAddress);
+        crc = smbusCrc8(crc, data[0]);
+        values[count++] = {0, data[0]};
+        payload = 1;
+    }
+    state.lastWriteLength = 0;
+
+    // Byte and word payloads are little-endian; longer blocks show their first four bytes
+    uint32_t word = 0;
+    for (size_t i = payload; i + 1 < length; i++) {
+        if (i - payload < 4) {
+            word |= (uint32_t)data[i] << (8 * (i - payload));
+        }
+    }
+    for (size_t i = transaction.isRead ? 0 : 1; i + 1 < length; i++) {
+        crc = smbusCrc8(crc, data[i]);
+    }
+    if (length - 1 > payload) {
+        values[count++] = {1, (int32_t)word};
+    }
+
+    check = crc == data[length - 1] ? CHECK_OK : CHECK_FAILED;
+    return count;
+}
+#endif
+
+#if DISSECTOR_TMP102
+// TI TMP102: 12-bit temperature in register 0, 13-bit in extended mode
+// (configuration register 1, EM bit)
+static const DissectorChannel TMP102_CHANNELS[] = {
+    {"temp", "C", 4, false},
+};
+
+static int decodeTmp102(DissectorState& state, const I2CTransaction& transaction,
+                        DissectorValue* values, DissectorCheck& check) {
+    if (trackPointer(state, transaction)) {
+        if (transaction.dataLength == 1) {
+            return 0;
+        }
+        if (state.pointer == 0x01 && transaction.dataLength >= 3) {
+            state.config[0] = (transaction.data[2] & 0x10) != 0;
+        }
+        return -1;
+    }
+
+    if (!state.pointerValid || state.pointer != 0x00 || transaction.dataLength < 2) {
+        return -1;
+    }
+    int16_t raw = readBigEndian16(transaction.data);
+    int32_t counts = state.config[0] ? raw >> 3 : raw >> 4;
+    values[0] = {0, counts * 625};  // 0.0625 C per count
+    return 1;
+}
+#endif
+
+#if DISSECTOR_LM75
+// LM75 family: temperature in register 0, left-justified; the LM75B's 11 bits
+// also read correctly on 9-bit parts, whose low bits are zero
+static const DissectorChannel LM75_CHANNELS[] = {
+    {"temp", "C", 3, false},
+};
+
+static int decodeLm75(DissectorState& state, const I2CTransaction& transaction,
+                      DissectorValue* values, DissectorCheck& check) {
+    if (trackPointer(state, transaction)) {
+        return transaction.dataLength == 1 ? 0 : -1;
+    }
+
+    if (!state.pointerValid || state.pointer != 0x00 || transaction.dataLength < 2) {
+        return -1;
+    }
+    int16_t raw = readBigEndian16(transaction.data);
+    values[0] = {0, (raw >> 5) * 125};  // 0.125 C per count
+    return 1;
+}
+#endif
+
+#if DISSECTOR_MPU6050
+// InvenSense MPU-6050/6500: burst reads anywhere in 0x3B-0x48. Full-scale
+// ranges are picked up from writes to GYRO_CONFIG (0x1B) and ACCEL_CONFIG
+// (0x1C); until one is seen the power-on ranges (+-250 dps, +-2 g) apply.
+static const DissectorChannel MPU6050_CHANNELS[] = {
+    {"ax", "mg", 0, false},
+    {"ay", "mg", 0, false},
+    {"az", "mg", 0, false},
+    {"temp", "C", 2, false},
+    {"gx", "dps", 2, false},
+    {"gy", "dps", 2, false},
+    {"gz", "dps", 2, false},
+};
+
+static const uint8_t MPU6050_DATA_START = 0x3B;
+static const uint8_t MPU6050_GYRO_CONFIG = 0x1B;
+static const uint8_t MPU6050_ACCEL_CONFIG = 0x1C;
+
+static int decodeMpu6050(DissectorState& state, const I2CTransaction& transaction,
+                         DissectorValue* values, DissectorCheck& check) {
+    if (trackPointer(state, transaction)) {
+        for (size_t i = 1; i < transaction.dataLength; i++) {
+            uint8_t reg = state.pointer + i - 1;
+            if (reg == MPU6050_GYRO_CONFIG) {
+                state.config[0] = (transaction.data[i] >> 3) & 0x03;
+            } else if (reg == MPU6050_ACCEL_CONFIG) {
+                state.config[1] = (transaction.data[i] >> 3) & 0x03;
+            }
+        }
+        return transaction.dataLength == 1 ? 0 : -1;
+    }
+
+    if (!state.pointerValid) {
+        return -1;
+    }
+
+    int count = 0;
+    for (int channel = 0; channel < 7; channel++) {
+        int offset = MPU6050_DATA_START + 2 * channel - state.pointer;
+        if (offset < 0 || offset + 2 > (int)transaction.dataLength) {
+            continue;
+        }
+
+        int32_t raw = readBigEndian16(transaction.data + offset);
+        int32_t value;
+        if (channel < 3) {
+            value = raw * 1000 / (16384 >> state.config[1]);
+        } else if (channel == 3) {
+            value = raw * 100 / 340 + 3653;  // raw / 340 + 36.53 C
+        } else {
+            value = raw * 100 * (1 << state.config[0]) / 131;
+        }
+        values[count++] = {(uint8_t)channel, value};
+    }
+    return count > 0 ? count : -1;
+}
+#endif
+
+const DissectorEntry DissectorEngine::REGISTRY[] = {
+#if DISSECTOR_SMBUS
+    {"SMBUS", 0x08, 0x77, SMBUS_CHANNELS, 2, decodeSmbus},
+#endif
+#if DISSECTOR_TMP102
+    {"TMP102", 0x48, 0x4B, TMP102_CHANNELS, 1, decodeTmp102},
+#endif
+#if DISSECTOR_LM75
+    {"LM75", 0x48, 0x4F, LM75_CHANNELS, 1, decodeLm75},
+#endif
+#if DISSECTOR_MPU6050
+    {"MPU6050", 0x68, 0x69, MPU6050_CHANNELS, 7, decodeMpu6050},
+#endif
+    {nullptr, 0, 0, nullptr, 0, nullptr}  // Keeps the table non-empty
+};
+
+const size_t DissectorEngine::REGISTRY_COUNT = sizeof(DissectorEngine::REGISTRY) / sizeof(DissectorEngine::REGISTRY[0]) - 1;
@@ -0,0 +1,131 @@
+#include "SettingsStore.h"
+
+const char* SettingsStore::NAMESPACE = "i2cble";
+const char* SettingsStore::SETTINGS_KEY = "settings";
+
+SettingsStore::SettingsStore() : fastStart(false) {
+}
+
+bool SettingsStore::load(I2CBusGroup& buses, OutputSettings& output) {
+    StoredSettings stored;
+    size_t length = 0;
+
+    if (preferences.begin(NAMESPACE, true)) {
+        if (preferences.getBytesLength(SETTINGS_KEY) == sizeof(stored)) {
+            length = preferences.getBytes(SETTINGS_KEY, &stored, sizeof(stored));
+        }
+        preferences.end();
+    }
+
+    if (length != sizeof(stored) || stored.version != VERSION) {
+        return false;
+    }
+    if (!isValid(stored)) {
+        // A corrupt blob must not reach the formatter or filter switches
+        output = defaultOutputSettings();
+        return false;
+    }
+
+    for (int bus = 0; bus < buses.getBusCount(); bus++) {
+        applyBus(stored.buses[bus], buses.getBus(bus));
+    }
+    output.serialMode = (SerialOutputMode)stored.serialMode;
+    output.dataFormat = (I2CFormatterType)stored.dataFormat;
+    fastStart = stored.fastStart;
+    return true;
+}
+
+bool SettingsStore::save(I2CBusGroup& buses, const OutputSettings& output) {
+    StoredSettings stored;
+    memset(&stored, 0, sizeof(stored));
+
+    stored.version = VERSION;
+    for (int bus = 0; bus < buses.getBusCount(); bus++) {
+        storeBus(buses.getBus(bus), stored.buses[bus]);
+    }
+    stored.serialMode = output.serialMode;
+    stored.dataFormat = output.dataFormat;
+    stored.fastStart = fastStart;
+
+    if (!preferences.begin(NAMESPACE, false)) {
+        return false;
+    }
+    size_t written = preferences.putBytes(SETTINGS_KEY, &stored, sizeof(stored));
+    preferences.end();
+    return written == sizeof(stored);
+}
+
+bool SettingsStore::reset(I2CBusGroup& buses, OutputSettings& output) {
+    for (int bus = 0; bus < buses.getBusCount(); bus++) {
+        buses.getBus(bus).getAddressFilter().clearRanges();
+        buses.getBus(bus).getRegisterShadow().setDiffMode(false);
+    }
+    output = defaultOutputSettings();
+    fastStart = false;
+
+    if (!preferences.begin(NAMESPACE, false)) {
+        return false;
+    }
+    bool cleared = preferences.clear();
+    preferences.end();
+    return cleared;
+}
+
+bool SettingsStore::isFastStart() {
+    return fastStart;
+}
+
+void SettingsStore::setFastStart(bool enabled) {
+    fastStart = enabled;
+}
+
+OutputSettings SettingsStore::defaultOutputSettings() {
+    OutputSettings output = {SERIAL_TEXT, I2CFormatterType::Binary};
+    return output;
+}
+
+bool SettingsStore::isValid(const StoredSettings& stored) {
+    if (stored.serialMode > SERIAL_BINARY || stored.dataFormat > I2CFormatterType::Decimal) {
+        return false;
+    }
+    for (int bus = 0; bus < I2CBusGroup::MAX_BUSES; bus++) {
+        const StoredBus& storedBus = stored.buses[bus];
+        int count = storedBus.rangeCount < AddressFilter::MAX_RANGES ? storedBus.rangeCount : AddressFilter::MAX_RANGES;
+        for (int i = 0; i < count; i++) {
+            if (storedBus.ranges[i].samplingMode > SAMPLE_FIRST) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void SettingsStore::applyBus(const StoredBus& stored, I2CListener& listener) {
+    AddressFilter& filter = listener.getAddressFilter();
+    filter.clearRanges();
+
+    int count = stored.rangeCount < AddressFilter::MAX_RANGES ? stored.rangeCount : AddressFilter::MAX_RANGES;
+    for (int i = 0; i < count; i++) {
+        const StoredRange& range = stored.ranges[i];
+        SamplingPolicy policy = {(SamplingMode)range.samplingMode, range.samplingLimit};
+        if (filter.addRange(range.minAddress, range.maxAddress, policy)) {
+            filter.setRangeEnabled(filter.getRangeCount() - 1, range.enabled);
+        }
+    }
+
+    listener.getRegisterShadow().setDiffMode(stored.shadowDiff);
+}
+
+void SettingsStore::storeBus(I2CListener& listener, StoredBus& stored) {
+    AddressFilter& filter = listener.getAddressFilter();
+    stored.rangeCount = filter.getRangeCount();
+    for (int i = 0; i < stored.rangeCount; i++) {
+        AddressRange range = filter.getRange(i);
+        stored.ranges[i].minAddress = range.minAddress;
+        stored.ranges[i].maxAddress = range.maxAddress;
+        stored.ranges[i].enabled = range.enabled;
+        stored.ranges[i].samplingMode = range.policy.mode;
+        stored.ranges[i].samplingLimit = range.policy.limit;
+    }
+    stored.shadowDiff = listener.getRegisterShadow().isDiffMode();
+}
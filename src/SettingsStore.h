@@ -0,0 +1,58 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "I2CBusGroup.h"
+#include "I2CFormatter.h"
+
+// Persists filter and output settings to NVS so they survive resets and are
+// applied before the sniffer attaches its interrupts.
+class SettingsStore {
+private:
+    static const char* NAMESPACE;
+    static const char* SETTINGS_KEY;
+    static const uint8_t VERSION = 2;
+
+    struct StoredRange {
+        uint8_t minAddress;
+        uint8_t maxAddress;
+        uint8_t enabled;
+        uint8_t samplingMode;
+        uint32_t samplingLimit;
+    };
+
+    struct StoredBus {
+        uint8_t rangeCount;
+        uint8_t shadowDiff;
+        StoredRange ranges[AddressFilter::MAX_RANGES];
+    };
+
+    struct StoredSettings {
+        uint8_t version;
+        uint8_t serialMode;
+        uint8_t dataFormat;
+        uint8_t fastStart;
+        StoredBus buses[I2CBusGroup::MAX_BUSES];
+    };
+
+    Preferences preferences;
+    bool fastStart;
+
+public:
+    SettingsStore();
+    bool load(I2CBusGroup& buses, OutputSettings& output);
+    bool save(I2CBusGroup& buses, const OutputSettings& output);
+    bool reset(I2CBusGroup& buses, OutputSettings& output);
+    bool isFastStart();
+    void setFastStart(bool enabled);
+
+    static OutputSettings defaultOutputSettings();
+
+private:
+    static bool isValid(const StoredSettings& stored);  // Enum fields in range
+    void applyBus(const StoredBus& stored, I2CListener& listener);
+    void storeBus(I2CListener& listener, StoredBus& stored);
+};
+
+#endif
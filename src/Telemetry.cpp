@@ -0,0 +1,119 @@
+#include "Telemetry.h"
+#include <esp_heap_caps.h>
+
+Telemetry::Telemetry() : taskCount(0), sampleCount(0), lastSampleMillis(0) {
+    memset(&latest, 0, sizeof(latest));
+}
+
+bool Telemetry::watchTask(const char* name, TaskHandle_t handle) {
+    if (!handle || taskCount >= MAX_TASKS) {
+        return false;
+    }
+    tasks[taskCount++] = {name, handle, 0};
+    return true;
+}
+
+bool Telemetry::watchTask(const char* name) {
+    return watchTask(name, xTaskGetHandle(name));
+}
+
+bool Telemetry::service() {
+    if (sampleCount > 0 && millis() - lastSampleMillis < SAMPLE_INTERVAL_MS) {
+        return false;
+    }
+    sample();
+    return true;
+}
+
+void Telemetry::sample() {
+    uint32_t start = micros();
+
+    latest.uptimeMillis = millis();
+    latest.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    latest.largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    latest.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    if (sampleCount == 0 || latest.largestFreeBlock < latest.minLargestFreeBlock) {
+        latest.minLargestFreeBlock = latest.largestFreeBlock;
+    }
+
+    // ESP-IDF reports the high-water mark in bytes, not words
+    for (int i = 0; i < taskCount; i++) {
+        UBaseType_t free = uxTaskGetStackHighWaterMark(tasks[i].handle);
+        tasks[i].stackHighWater = free > 0xFFFF ? 0xFFFF : free;
+    }
+
+    lastSampleMillis = latest.uptimeMillis;
+    sampleCount++;
+    uint32_t elapsed = micros() - start;
+    latest.sampleMicros = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+}
+
+const TelemetrySample& Telemetry::getLatest() const {
+    return latest;
+}
+
+uint32_t Telemetry::getSampleCount() const {
+    return sampleCount;
+}
+
+bool Telemetry::isLowHeap() const {
+    return sampleCount > 0 && latest.freeHeap < LOW_HEAP_BYTES;
+}
+
+int Telemetry::getTaskCount() const {
+    return taskCount;
+}
+
+const char* Telemetry::getTaskName(int index) const {
+    return tasks[index].name;
+}
+
+uint16_t Telemetry::getStackHighWater(int index) const {
+    return tasks[index].stackHighWater;
+}
+
+size_t Telemetry::encodeRecord(I2CBusGroup& buses, uint8_t* record) {
+    size_t length = 0;
+    record[length++] = RECORD_VERSION;
+    record[length++] = taskCount;
+    record[length++] = buses.getBusCount();
+    record[length++] = isLowHeap() ? FLAG_LOW_HEAP : 0;
+    writeU32(record + length, latest.uptimeMillis);
+    writeU32(record + length + 4, sampleCount);
+    writeU16(record + length + 8, latest.sampleMicros);
+    length += 10;
+    writeU32(record + length, latest.freeHeap);
+    writeU32(record + length + 4, latest.largestFreeBlock);
+    writeU32(record + length + 8, latest.minFreeHeap);
+    writeU32(record + length + 12, latest.minLargestFreeBlock);
+    length += 16;
+
+    for (int i = 0; i < taskCount; i++) {
+        writeU16(record + length, tasks[i].stackHighWater);
+        length += 2;
+    }
+
+    // Queue state is read live; it is only a few volatile loads per bus
+    for (int bus = 0; bus < buses.getBusCount(); bus++) {
+        I2CListener& listener = buses.getBus(bus);
+        size_t backlog = listener.getEdgeBacklog();
+        record[length] = listener.getQueueDepth();
+        record[length + 1] = listener.getPeakQueueDepth();
+        writeU16(record + length + 2, backlog > 0xFFFF ? 0xFFFF : backlog);
+        writeU32(record + length + 4, listener.getDroppedTransactionCount());
+        length += 8;
+    }
+    return length;
+}
+
+void Telemetry::writeU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void Telemetry::writeU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
@@ -0,0 +1,72 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "I2CBusGroup.h"
+
+// Heap, stack and queue health for long-running captures, sampled from the
+// main loop every SAMPLE_INTERVAL_MS. A sample walks the heap once to find
+// the largest free block and reads a few counters, so it costs tens of
+// microseconds a second.
+//
+// Binary record (STATS in a binary batch), all little-endian:
+//   version u8 | task count u8 | bus count u8 | flags u8
+//   uptime ms u32 | samples u32 | last sample cost us u16
+//   free heap u32 | largest free block u32 | min free heap u32 | min largest block u32
+//   per task: stack high-water mark bytes u16
+//   per bus:  queue depth u8 | peak queue depth u8 | edge backlog u16 | dropped u32
+// Flag 0x01 is set while the heap is below LOW_HEAP_BYTES.
+
+struct TelemetrySample {
+    uint32_t uptimeMillis;
+    uint32_t freeHeap;
+    uint32_t largestFreeBlock;
+    uint32_t minFreeHeap;          // Lowest since boot, tracked by the allocator
+    uint32_t minLargestFreeBlock;  // Lowest seen by a sample
+    uint16_t sampleMicros;
+};
+
+class Telemetry {
+public:
+    static const int MAX_TASKS = 4;
+    static const uint8_t RECORD_VERSION = 1;
+    static const uint8_t FLAG_LOW_HEAP = 0x01;
+    static const size_t MAX_RECORD_SIZE = 32 + MAX_TASKS * 2 + I2CBusGroup::MAX_BUSES * 8;
+    static const unsigned long SAMPLE_INTERVAL_MS = 1000;
+    static const uint32_t LOW_HEAP_BYTES = 16384;
+
+private:
+    struct WatchedTask {
+        const char* name;
+        TaskHandle_t handle;
+        uint16_t stackHighWater;
+    };
+
+    WatchedTask tasks[MAX_TASKS];
+    int taskCount;
+    TelemetrySample latest;
+    uint32_t sampleCount;
+    unsigned long lastSampleMillis;
+
+public:
+    Telemetry();
+    bool watchTask(const char* name, TaskHandle_t handle);
+    bool watchTask(const char* name);  // Looked up by FreeRTOS task name
+    bool service();                    // Samples when the interval has passed
+    void sample();
+    const TelemetrySample& getLatest() const;
+    uint32_t getSampleCount() const;
+    bool isLowHeap() const;
+    int getTaskCount() const;
+    const char* getTaskName(int index) const;
+    uint16_t getStackHighWater(int index) const;  // Bytes never used, 0 if unknown
+    size_t encodeRecord(I2CBusGroup& buses, uint8_t* record);
+
+private:
+    static void writeU16(uint8_t* out, uint16_t value);
+    static void writeU32(uint8_t* out, uint32_t value);
+};
+
+#endif
@@ -1,20 +1,118 @@
 #include "BLESerial.h"
-#include "I2CListener.h"
+#include "I2CBusGroup.h"
 #include "I2CFormatter.h"
 #include "ConfigParser.h"
+#include "BinaryFrame.h"
+#include "ClientSession.h"
+#include "CompressedStream.h"
+#include "SettingsStore.h"
+#include "Telemetry.h"
+#include "EventLoop.h"
+#include "Dissector.h"
 
 #define LED_1 12
 #define LED_2 13
+#define BLE_RAW_CHUNK 20  // Default ATT MTU payload
+#define SHADOW_SUMMARY_INTERVAL 10000
+#define SAMPLING_SUMMARY_INTERVAL 5000
+#define HEARTBEAT_INTERVAL 30000
+#define COMPRESS_FLUSH_INTERVAL 10  // Longest a compressed record waits for its block to fill
+#define RAW_FLUSH_INTERVAL 10       // Longest raw edges below EDGE_WAKE_THRESHOLD wait
+#define SERIAL_TX_BUFFER 4096
+#define CONFIG_QUEUE_SIZE 4    // Config writes waiting for the loop task
+#define CONFIG_WRITE_SIZE 512  // Longest ATT attribute value
+#define LATENCY_TRAILER_SIZE 40  // " @<stop>,<dequeue>,<notify>\n", 32-bit stamps
+// Header plus the widest data format (binary, "0b" + 8 bits + space per byte)
+#define LATENCY_LINE_SIZE (48 + I2CDecoder::MAX_DATA_SIZE * 11 + LATENCY_TRAILER_SIZE)
+
+#ifndef I2C_BUS_COUNT
+#define I2C_BUS_COUNT 1  // Build with -DI2C_BUS_COUNT=2 or 3 for extra segments
+#endif
+
+static const I2CBusPins BUS_PINS[I2CBusGroup::MAX_BUSES] = {
+    {I2CListener::DEFAULT_SDA_PIN, I2CListener::DEFAULT_SCL_PIN},
+    {6, 7},
+    {0, 1}};
 
 BLESerial bleSerial;
-I2CListener i2cListener;
+I2CBusGroup i2cBuses;
 I2CFormatter formatter;
+BinaryFrameWriter frameWriter;
+ClientSessions clientSessions;
+SettingsStore settingsStore;
+Telemetry telemetry;
+DissectorEngine dissectors;
+EventLoop events;
+OutputSettings outputSettings = SettingsStore::defaultOutputSettings();
+ConfigContext configContext = {i2cBuses, 0, outputSettings, settingsStore, telemetry, dissectors, nullptr};
 
-void onI2CData(const I2CTransaction &transaction)
+static_assert(ClientSessions::MAX_SESSIONS == BLESerial::MAX_CLIENTS, "One session per BLE connection");
+
+// Config writes arrive on BTC_TASK. They are copied here and parsed on the
+// loop task, so a command never changes filters, sessions, the shadow or
+// dissector bindings while the loop is using them.
+struct PendingConfig
+{
+  uint16_t clientId;
+  size_t length;
+  uint8_t data[CONFIG_WRITE_SIZE];
+};
+PendingConfig pendingConfig[CONFIG_QUEUE_SIZE];
+volatile size_t pendingConfigHead = 0;
+volatile size_t pendingConfigTail = 0;
+
+// Summaries are stamped with the last delivered transaction's START rather
+// than micros(), so they never sort ahead of transactions still queued
+unsigned long lastDeliveredTimestamp = 0;
+
+// A transaction's text, formatted at most once per data format however many
+// clients ask for it. Diff-mode and dissected lines read the same in every format.
+struct TransactionText
 {
-  String formattedData = formatter.formatTransaction(transaction);
+  const I2CTransaction &transaction;
+  const RegisterChange *changes;
+  size_t changeCount;
+  const DissectorRecord *record;
+  String text[3];
+  bool formatted[3];
+
+  TransactionText(const I2CTransaction &transaction, const RegisterChange *changes = nullptr, size_t changeCount = 0)
+      : transaction(transaction), changes(changes), changeCount(changeCount), record(nullptr), formatted{false, false, false}
+  {
+  }
+
+  TransactionText(const I2CTransaction &transaction, const DissectorRecord &record)
+      : transaction(transaction), changes(nullptr), changeCount(0), record(&record), formatted{false, false, false}
+  {
+  }
+
+  const String &get(I2CFormatterType kind)
+  {
+    int slot = changes || record ? 0 : kind;
+    if (!formatted[slot])
+    {
+      if (record)
+      {
+        text[slot] = formatter.formatDissectorRecord(*record);
+      }
+      else
+      {
+        text[slot] = changes ? formatter.formatRegisterChanges(transaction, changes, changeCount)
+                             : formatter.formatTransaction(transaction, kind);
+      }
+      formatted[slot] = true;
+    }
+    return text[slot];
+  }
+};
 
-  Serial.print(formattedData);
+void sendData(const String &formattedData)
+{
+  // In binary mode the serial port carries only framed records
+  if (outputSettings.serialMode == SERIAL_TEXT)
+  {
+    Serial.print(formattedData);
+  }
 
   if (bleSerial.isConnected())
   {
@@ -22,54 +120,444 @@ void onI2CData(const I2CTransaction &transaction)
   }
 }
 
-void onBLEConfig(const String &command)
+void flushCompressedBlock(ClientSession &session)
 {
-  String response;
-  ConfigParser::CommandResult result = ConfigParser::parseCommand(
-      command,
-      i2cListener.getAddressFilter(),
-      response);
+  if (!session.compressedWriter.isEmpty())
+  {
+    size_t length = session.compressedWriter.finish();
+    bleSerial.write(session.clientId, session.compressedWriter.data(), length);
+  }
+}
 
-  Serial.println("BLE Config: " + command);
-  Serial.println("Response: " + response);
+void appendCompressed(ClientSession &session, const I2CTransaction &transaction)
+{
+  if (session.compressedWriter.isEmpty())
+  {
+    session.blockStarted = millis();
+  }
+  if (session.compressedWriter.append(transaction))
+  {
+    return;
+  }
+  flushCompressedBlock(session);
+  session.blockStarted = millis();
+  if (!session.compressedWriter.append(transaction))
+  {
+    // Only possible below a 44-byte payload; reported with the DROPPED summary
+    session.compressedDropped++;
+  }
+}
 
-  if (bleSerial.isConnected())
+// With COMPRESS ON, a client's transactions are collected into one compressed
+// block until it fills or COMPRESS_FLUSH_INTERVAL passes; a new session always
+// starts with a dictionary reset
+void serviceCompression()
+{
+  for (int i = 0; i < ClientSessions::MAX_SESSIONS; i++)
   {
-    bleSerial.writeStatus(response);
+    if (!clientSessions.isActive(i))
+    {
+      continue;
+    }
+    ClientSession &session = clientSessions.get(i);
+    if (session.compression && !session.compressionActive)
+    {
+      session.compressedWriter.reset();
+    }
+    else if (!session.compression && session.compressionActive)
+    {
+      // Records already collected go out before the client switches to text
+      flushCompressedBlock(session);
+    }
+    session.compressionActive = session.compression;
+
+    if (!session.compressionActive)
+    {
+      continue;
+    }
+    session.compressedWriter.setBlockLimit(bleSerial.getNotifyPayloadSize(session.clientId));
+    if (session.compressedWriter.isEmpty())
+    {
+      continue;
+    }
+    unsigned long left = EventLoop::remaining(session.blockStarted, COMPRESS_FLUSH_INTERVAL);
+    if (left == 0)
+    {
+      flushCompressedBlock(session);
+    }
+    else
+    {
+      events.wakeWithin(left);
+    }
   }
 }
 
-void setup()
+// Compressed clients get every raw transaction their filter admits, whether
+// or not a dissector or SHADOW diff mode reshapes the text lines
+void sendCompressedData(const I2CTransaction &transaction)
 {
+  for (int i = 0; i < ClientSessions::MAX_SESSIONS; i++)
+  {
+    if (!clientSessions.isActive(i))
+    {
+      continue;
+    }
+    ClientSession &session = clientSessions.get(i);
+    if (session.compressionActive && ClientSessions::admits(session, transaction))
+    {
+      appendCompressed(session, transaction);
+    }
+  }
+}
+
+// Serial gets the device format; each text BLE client gets the transactions
+// its own filter admits, in its own format. With LATENCY ON a client's lines end
+// in " @<stop>,<dequeue>,<notify>" (device micros) so it can split
+// bus-to-screen latency into stages.
+void sendTransactionData(TransactionText &text, uint32_t dequeueMicros)
+{
+  const I2CTransaction &transaction = text.transaction;
+
+  if (outputSettings.serialMode == SERIAL_TEXT)
+  {
+    Serial.print(text.get(outputSettings.dataFormat));
+  }
+
+  for (int i = 0; i < ClientSessions::MAX_SESSIONS; i++)
+  {
+    if (!clientSessions.isActive(i))
+    {
+      continue;
+    }
+    ClientSession &session = clientSessions.get(i);
+    if (session.compressionActive || !ClientSessions::admits(session, transaction))
+    {
+      continue;
+    }
+
+    const String &line = text.get(ClientSessions::formatFor(session, outputSettings));
+    if (!session.latencyStamps)
+    {
+      bleSerial.write(session.clientId, reinterpret_cast<const uint8_t *>(line.c_str()), line.length());
+      continue;
+    }
+
+    int length = line.length();
+    if (length > 0 && line.charAt(length - 1) == '\n')
+    {
+      length--;
+    }
+
+    // The stamps are formatted first and the line is cut to fit one
+    // notification with them, so it loses payload, never the stamps. Below
+    // an MTU that can carry them at all the line goes out unstamped.
+    char trailer[LATENCY_TRAILER_SIZE];
+    int trailerLength = snprintf(trailer, sizeof(trailer), " @%lu,%lu,%lu\n", (unsigned long)transaction.endTimestamp,
+                                 (unsigned long)dequeueMicros, (unsigned long)micros());
+    char stamped[LATENCY_LINE_SIZE];
+    int limit = min(bleSerial.getNotifyPayloadSize(session.clientId), sizeof(stamped) - 1);
+    if (trailerLength >= limit)
+    {
+      bleSerial.write(session.clientId, reinterpret_cast<const uint8_t *>(line.c_str()), line.length());
+      continue;
+    }
+    length = min(length, limit - trailerLength);
+    memcpy(stamped, line.c_str(), length);
+    memcpy(stamped + length, trailer, trailerLength);
+    bleSerial.write(session.clientId, reinterpret_cast<const uint8_t *>(stamped), length + trailerLength);
+  }
+}
+
+void onI2CData(const I2CTransaction &transaction)
+{
+  // Stamped as the loop takes the transaction off the interrupt queue
+  uint32_t dequeueMicros = micros();
+  lastDeliveredTimestamp = transaction.timestamp;
+
+  if (outputSettings.serialMode == SERIAL_BINARY)
+  {
+    uint8_t frame[BinaryFrame::MAX_FRAME_SIZE];
+    size_t length = frameWriter.encodeTransaction(transaction, frame);
+    Serial.write(frame, length);
+  }
+  sendCompressedData(transaction);
+
+  RegisterShadow &shadow = i2cBuses.getBus(transaction.busId).getRegisterShadow();
+  RegisterChange changes[I2CDecoder::MAX_DATA_SIZE];
+  size_t changeCount = 0;
+  bool mirrored = shadow.apply(transaction, changes, I2CDecoder::MAX_DATA_SIZE, changeCount);
+
+  // Bound devices report decoded values instead of bytes; the shadow above
+  // still mirrors them
+  DissectorRecord record;
+  DissectorEngine::Result dissected = dissectors.process(transaction, record);
+  if (dissected == DissectorEngine::ABSORBED)
+  {
+    return;
+  }
+  if (dissected == DissectorEngine::DISSECTED)
+  {
+    TransactionText text(transaction, record);
+    sendTransactionData(text, dequeueMicros);
+    return;
+  }
 
+  if (shadow.isDiffMode() && mirrored)
+  {
+    // Only registers whose value changed are streamed
+    if (changeCount > 0)
+    {
+      TransactionText text(transaction, changes, changeCount);
+      sendTransactionData(text, dequeueMicros);
+    }
+    return;
+  }
+
+  TransactionText text(transaction);
+  sendTransactionData(text, dequeueMicros);
+}
+
+// Finished min/max/mean windows go to every client, like the other summaries
+void serviceDissectors()
+{
+  DissectorWindow window;
+  while (dissectors.collectWindow(window))
+  {
+    sendData(formatter.formatDissectorWindow(window));
+  }
+
+  unsigned long deadline;
+  if (dissectors.getDeadline(deadline))
+  {
+    events.wakeBy(deadline);
+  }
+}
+
+void sendShadowSummary()
+{
+  for (int bus = 0; bus < i2cBuses.getBusCount(); bus++)
+  {
+    RegisterShadow &shadow = i2cBuses.getBus(bus).getRegisterShadow();
+    if (!shadow.isDiffMode())
+    {
+      continue;
+    }
+    for (int i = 0; i < shadow.getDeviceCount(); i++)
+    {
+      sendData(formatter.formatShadowSummary(bus, shadow.getDeviceStats(i), lastDeliveredTimestamp));
+    }
+    shadow.resetDeviceStats();
+  }
+}
+
+void sendSamplingSummary()
+{
+  static uint32_t reportedDropped[I2CBusGroup::MAX_BUSES] = {0};
+
+  for (int bus = 0; bus < i2cBuses.getBusCount(); bus++)
+  {
+    I2CListener &listener = i2cBuses.getBus(bus);
+    AddressFilter &filter = listener.getAddressFilter();
+    for (int i = 0; i < filter.getRangeCount(); i++)
+    {
+      uint32_t suppressed = filter.collectSuppressed(i);
+      if (suppressed > 0)
+      {
+        sendData(formatter.formatSuppressedSummary(bus, filter.getRange(i), suppressed, lastDeliveredTimestamp));
+      }
+    }
+
+    uint32_t dropped = listener.getDroppedTransactionCount();
+    if (dropped != reportedDropped[bus])
+    {
+      if (outputSettings.serialMode == SERIAL_BINARY)
+      {
+        uint8_t frame[BinaryFrame::MAX_FRAME_SIZE];
+        size_t length = frameWriter.encodeDropped(bus, dropped - reportedDropped[bus], lastDeliveredTimestamp, frame);
+        Serial.write(frame, length);
+      }
+      sendData(formatter.formatDroppedSummary(bus, dropped - reportedDropped[bus], lastDeliveredTimestamp));
+      reportedDropped[bus] = dropped;
+    }
+  }
+
+  // Compressed-stream losses only concern the client that had them
+  for (int i = 0; i < ClientSessions::MAX_SESSIONS; i++)
+  {
+    if (!clientSessions.isActive(i) || clientSessions.get(i).compressedDropped == 0)
+    {
+      continue;
+    }
+    ClientSession &session = clientSessions.get(i);
+    String line = formatter.formatDroppedSummary(0, session.compressedDropped, lastDeliveredTimestamp, "COMPRESS");
+    bleSerial.write(session.clientId, reinterpret_cast<const uint8_t *>(line.c_str()), line.length());
+    session.compressedDropped = 0;
+  }
+}
+
+void onI2CRaw(uint8_t busId, const uint8_t *data, size_t length)
+{
+  Serial.write(data, length);
+
+  if (i2cBuses.getBus(busId).getCaptureMode() == CAPTURE_RAW_BLE && bleSerial.isConnected())
+  {
+    // Edge blocks are self-synchronising, so they can be split across notifications
+    for (size_t offset = 0; offset < length; offset += BLE_RAW_CHUNK)
+    {
+      size_t chunk = min((size_t)BLE_RAW_CHUNK, length - offset);
+      bleSerial.write(const_cast<uint8_t *>(data + offset), chunk);
+    }
+  }
+}
+
+void onBLEConfig(uint16_t clientId, const uint8_t *data, size_t length)
+{
+  size_t next = (pendingConfigHead + 1) % CONFIG_QUEUE_SIZE;
+  if (next == pendingConfigTail || length > CONFIG_WRITE_SIZE)
+  {
+    static const char busy[] = "ERROR: Command dropped, device busy.";
+    bleSerial.writeStatus(clientId, reinterpret_cast<const uint8_t *>(busy), sizeof(busy) - 1);
+    return;
+  }
+
+  PendingConfig &pending = pendingConfig[pendingConfigHead];
+  pending.clientId = clientId;
+  pending.length = length;
+  memcpy(pending.data, data, length);
+  pendingConfigHead = next;
+  EventLoop::signal(EventLoop::EVENT_CONFIG);
+}
+
+// Runs first in each pass, so the rest of the pass sees the new settings
+void serviceConfig()
+{
+  // Static: too large for the loop task's stack
+  static ConfigResponse response;
+
+  while (pendingConfigTail != pendingConfigHead)
+  {
+    const PendingConfig &pending = pendingConfig[pendingConfigTail];
+    response.clear();
+    configContext.client = clientSessions.find(pending.clientId);
+    ConfigParser::parseBatch(pending.data, pending.length, configContext, response);
+    configContext.client = nullptr;
+
+    if (outputSettings.serialMode == SERIAL_TEXT && !ConfigParser::isBinary(pending.data, pending.length))
+    {
+      Serial.printf("BLE Config (client %u): ", pending.clientId);
+      Serial.write(pending.data, pending.length);
+      Serial.println();
+      Serial.print("Response: ");
+      Serial.println(response.c_str());
+    }
+
+    // Only the client that sent the commands sees the response
+    bleSerial.writeStatus(pending.clientId, response.data(), response.length());
+    pendingConfigTail = (pendingConfigTail + 1) % CONFIG_QUEUE_SIZE;
+  }
+}
+
+void onBLEClient(uint16_t clientId, bool connected)
+{
+  if (!connected)
+  {
+    clientSessions.close(clientId);
+  }
+  else if (!clientSessions.open(clientId))
+  {
+    Serial.printf("No session free for BLE client %u\n", clientId);
+  }
+  Serial.printf("BLE clients: %d\n", clientSessions.getActiveCount());
+}
+
+// Warns once each time free heap falls below Telemetry::LOW_HEAP_BYTES
+void serviceTelemetry()
+{
+  static bool warnedLowHeap = false;
+  bool sampled = telemetry.service();
+  events.wakeWithin(EventLoop::remaining(telemetry.getLatest().uptimeMillis, Telemetry::SAMPLE_INTERVAL_MS));
+  if (!sampled)
+  {
+    return;
+  }
+
+  if (telemetry.isLowHeap() && !warnedLowHeap)
+  {
+    const TelemetrySample &sample = telemetry.getLatest();
+    char warning[96];
+    int length = snprintf(warning, sizeof(warning), "WARNING: Low heap - %lu free, %lu largest block\n",
+                          (unsigned long)sample.freeHeap, (unsigned long)sample.largestFreeBlock);
+    if (outputSettings.serialMode == SERIAL_TEXT)
+    {
+      Serial.print(warning);
+    }
+    // No String here: the heap is what is running out
+    if (bleSerial.isConnected())
+    {
+      bleSerial.writeStatus(reinterpret_cast<const uint8_t *>(warning), length);
+    }
+  }
+  warnedLowHeap = telemetry.isLowHeap();
+}
+
+void setup()
+{
+  EventLoop::begin();
   pinMode(LED_1, OUTPUT);
   pinMode(LED_2, OUTPUT);
   digitalWrite(LED_1, HIGH);
   digitalWrite(LED_2, HIGH);
+
+  for (int bus = 0; bus < I2C_BUS_COUNT; bus++)
+  {
+    i2cBuses.addBus(BUS_PINS[bus].sdaPin, BUS_PINS[bus].sclPin);
+  }
+
+  // Saved filters must be in place before the first interrupt fires
+  bool settingsLoaded = settingsStore.load(i2cBuses, outputSettings);
+  bool fastStart = settingsStore.isFastStart();
+  i2cBuses.setDataCallback(onI2CData);
+  i2cBuses.setRawCallback(onI2CRaw);
+
+  Serial.setTxBufferSize(SERIAL_TX_BUFFER);
   Serial.begin(115200);
   digitalWrite(LED_2, LOW);
 
-  unsigned long lastScan = millis();
-  while (!Serial && millis() - lastScan < 10000)
-    ;
+  if (fastStart)
+  {
+    // Headless: start capturing now, the serial host can attach any time
+    i2cBuses.begin();
+  }
+  else
+  {
+    unsigned long lastScan = millis();
+    while (!Serial && millis() - lastScan < 10000)
+      ;
+  }
   digitalWrite(LED_1, LOW);
 
   Serial.println("\n=== I2C BLE Logger Starting ===");
   Serial.println("ESP32-C3 USB CDC Serial Active");
+  Serial.println(settingsLoaded ? "Loaded saved settings" : "No saved settings - using defaults");
 
-  // Initialize I2C first (simpler initialization)
-  Serial.println("Initializing I2C...");
-  if (!i2cListener.begin())
+  if (!fastStart)
   {
-    Serial.println("ERROR: Failed to initialize I2C");
-    return;
-  }
-  Serial.println("✓ I2C initialized successfully");
+    // Initialize I2C first (simpler initialization)
+    Serial.println("Initializing I2C...");
+    if (!i2cBuses.begin())
+    {
+      Serial.println("ERROR: Failed to initialize I2C");
+      return;
+    }
+    Serial.println("✓ I2C initialized successfully");
 
-  // Add delay before BLE initialization
-  digitalWrite(LED_2, HIGH);
-  delay(1000);
-  digitalWrite(LED_2, LOW);
+    // Add delay before BLE initialization
+    digitalWrite(LED_2, HIGH);
+    delay(1000);
+    digitalWrite(LED_2, LOW);
+  }
+  Serial.printf("Boot to capture: %lu us (%s start)\n",
+                (unsigned long)i2cBuses.getBus(0).getCaptureStartMicros(), fastStart ? "fast" : "normal");
 
   // Initialize BLE with error handling
   Serial.println("Initializing BLE...");
@@ -83,12 +571,22 @@ void setup()
     Serial.println("✓ BLE initialized successfully");
   }
 
-  i2cListener.setDataCallback(onI2CData);
   bleSerial.setConfigCallback(onBLEConfig);
+  bleSerial.setClientCallback(onBLEClient);
+
+  // setup() runs on the Arduino loop task; the BLE callbacks run on BTC_TASK
+  telemetry.watchTask("loopTask", xTaskGetCurrentTaskHandle());
+  telemetry.watchTask("BTC_TASK");
+  telemetry.watchTask("BTU_TASK");
+  telemetry.sample();
 
   Serial.println("=== I2C BLE Logger Ready ===");
   Serial.println("Device name: I2C-BLE-Logger");
-  Serial.println("I2C pins - SDA: GPIO4, SCL: GPIO5");
+  for (int bus = 0; bus < i2cBuses.getBusCount(); bus++)
+  {
+    Serial.printf("I2C bus %d pins - SDA: GPIO%d, SCL: GPIO%d\n",
+                  bus, i2cBuses.getBus(bus).getSDAPin(), i2cBuses.getBus(bus).getSCLPin());
+  }
   Serial.println("BLE Services:");
   Serial.println("  - Serial: 6E400001-B5A3-F393-E0A9-E50E24DCCA9E");
   Serial.println("  - Config: 12345678-1234-1234-1234-123456789ABC");
@@ -96,22 +594,64 @@ void setup()
   Serial.println("Monitoring I2C bus...\n");
 }
 
+// Each pass handles whatever is due, registers its next deadline with
+// events and sleeps until an interrupt, a BLE callback or that deadline
+// wakes it. Nothing in a pass blocks.
 void loop()
 {
+  serviceConfig();
   bleSerial.handleConnection();
+  unsigned long advertiseDeadline;
+  if (bleSerial.getDeadline(advertiseDeadline))
+  {
+    events.wakeBy(advertiseDeadline);
+  }
 
   // Process I2C data (passive listening - no bus scanning needed)
-  i2cListener.processI2C();
+  i2cBuses.processI2C();
+  serviceCompression();
+  serviceDissectors();
+  serviceTelemetry();
+
+  static unsigned long lastSamplingSummary = 0;
+  if (EventLoop::remaining(lastSamplingSummary, SAMPLING_SUMMARY_INTERVAL) == 0)
+  {
+    sendSamplingSummary();
+    lastSamplingSummary = millis();
+  }
+  events.wakeWithin(EventLoop::remaining(lastSamplingSummary, SAMPLING_SUMMARY_INTERVAL));
+
+  static unsigned long lastShadowSummary = 0;
+  if (EventLoop::remaining(lastShadowSummary, SHADOW_SUMMARY_INTERVAL) == 0)
+  {
+    sendShadowSummary();
+    lastShadowSummary = millis();
+  }
+  events.wakeWithin(EventLoop::remaining(lastShadowSummary, SHADOW_SUMMARY_INTERVAL));
 
   if (bleSerial.isConnected())
   {
     static unsigned long lastHeartbeat = 0;
-    if (millis() - lastHeartbeat > 30000)  // Reduced heartbeat frequency
+    if (EventLoop::remaining(lastHeartbeat, HEARTBEAT_INTERVAL) == 0)
     {
       bleSerial.writeStatus("I2C Passive Sniffer Active - " + String(millis() / 1000) + "s uptime");
       lastHeartbeat = millis();
     }
+    events.wakeWithin(EventLoop::remaining(lastHeartbeat, HEARTBEAT_INTERVAL));
   }
 
-  delay(10);  // Reduced delay for better I2C responsiveness
+  for (int bus = 0; bus < i2cBuses.getBusCount(); bus++)
+  {
+    if (i2cBuses.getBus(bus).getCaptureMode() != CAPTURE_DECODE)
+    {
+      events.wakeWithin(RAW_FLUSH_INTERVAL);
+    }
+  }
+
+  // processI2C() delivers a bounded batch; go round again without sleeping
+  if (i2cBuses.hasPendingTransactions())
+  {
+    events.wakeWithin(0);
+  }
+  events.wait();
 }
@@ -0,0 +1,699 @@
+#include "CaptureStore.h"
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+static const size_t RECORD_HEADER_SIZE = 14;
+
+static void writeU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static void writeU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+static void writeU64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+static uint16_t readU16(const uint8_t* data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t readU32(const uint8_t* data) {
+    return (uint32_t)data[0] |
+           ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) |
+           ((uint32_t)data[3] << 24);
+}
+
+static uint64_t readU64(const uint8_t* data) {
+    return (uint64_t)readU32(data) | ((uint64_t)readU32(data + 4) << 32);
+}
+
+CaptureQuery::CaptureQuery()
+    : from(0), to(UINT64_MAX), address(-1), busId(-1), direction(-1) {
+}
+
+// --- SegmentIndex ---
+
+SegmentIndex::SegmentIndex() {
+    clear();
+}
+
+void SegmentIndex::clear() {
+    recordCount = 0;
+    firstTimestamp = 0;
+    lastTimestamp = 0;
+    timeStamps.clear();
+    timeOffsets.clear();
+    for (int i = 0; i < ADDRESS_COUNT; i++) {
+        postingLists[i].clear();
+    }
+    mappedTimeEntries = nullptr;
+    mappedTimeCount = 0;
+    mappedDirectory = nullptr;
+    mappedPostings = nullptr;
+}
+
+bool SegmentIndex::isMapped() const {
+    return mappedDirectory != nullptr;
+}
+
+void SegmentIndex::add(uint32_t offset, const StoredRecord& record) {
+    if (recordCount == 0) {
+        firstTimestamp = record.timestamp;
+    }
+    if (recordCount % TIME_INDEX_INTERVAL == 0) {
+        timeStamps.push_back(record.timestamp);
+        timeOffsets.push_back(offset);
+    }
+    if (!(record.flags & STORE_FLAG_DROPPED)) {
+        postingLists[record.address & 0x7F].push_back(offset);
+    }
+    lastTimestamp = record.timestamp;
+    recordCount++;
+}
+
+bool SegmentIndex::attach(const uint8_t* data, size_t length) {
+    clear();
+    if (length < HEADER_SIZE || readU32(data) != MAGIC || readU32(data + 4) != VERSION) {
+        return false;
+    }
+
+    uint32_t count = readU32(data + 8);
+    uint32_t timeCount = readU32(data + 12);
+    size_t directoryOffset = HEADER_SIZE + (size_t)timeCount * TIME_ENTRY_SIZE;
+    size_t postingsOffset = directoryOffset + ADDRESS_COUNT * 8;
+    if (length < postingsOffset) {
+        return false;
+    }
+
+    // Every posting list must lie inside the file
+    size_t postingBytes = length - postingsOffset;
+    for (int i = 0; i < ADDRESS_COUNT; i++) {
+        uint64_t start = readU32(data + directoryOffset + i * 8);
+        uint64_t entries = readU32(data + directoryOffset + i * 8 + 4);
+        if ((start + entries) * 4 > postingBytes) {
+            return false;
+        }
+    }
+
+    recordCount = count;
+    firstTimestamp = readU64(data + 16);
+    lastTimestamp = readU64(data + 24);
+    mappedTimeEntries = data + HEADER_SIZE;
+    mappedTimeCount = timeCount;
+    mappedDirectory = data + directoryOffset;
+    mappedPostings = data + postingsOffset;
+    return true;
+}
+
+bool SegmentIndex::write(const char* path) const {
+    // Write to a temporary file so readers never see a partial index
+    std::string temporary = std::string(path) + ".tmp";
+    FILE* output = fopen(temporary.c_str(), "wb");
+    if (!output) {
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE];
+    writeU32(header, MAGIC);
+    writeU32(header + 4, VERSION);
+    writeU32(header + 8, recordCount);
+    writeU32(header + 12, timeEntryCount());
+    writeU64(header + 16, firstTimestamp);
+    writeU64(header + 24, lastTimestamp);
+    fwrite(header, 1, sizeof(header), output);
+
+    for (uint32_t i = 0; i < timeEntryCount(); i++) {
+        uint8_t entry[TIME_ENTRY_SIZE];
+        writeU64(entry, timeEntryTimestamp(i));
+        writeU32(entry + 8, timeEntryOffset(i));
+        fwrite(entry, 1, sizeof(entry), output);
+    }
+
+    uint32_t start = 0;
+    for (int i = 0; i < ADDRESS_COUNT; i++) {
+        uint8_t entry[8];
+        writeU32(entry, start);
+        writeU32(entry + 4, postingCount(i));
+        fwrite(entry, 1, sizeof(entry), output);
+        start += postingCount(i);
+    }
+
+    for (int i = 0; i < ADDRESS_COUNT; i++) {
+        for (uint32_t position = 0; position < postingCount(i); position++) {
+            uint8_t entry[4];
+            writeU32(entry, posting(i, position));
+            fwrite(entry, 1, sizeof(entry), output);
+        }
+    }
+
+    bool ok = fflush(output) == 0 && !ferror(output);
+    ok = fclose(output) == 0 && ok;
+    return ok && rename(temporary.c_str(), path) == 0;
+}
+
+uint32_t SegmentIndex::timeEntryCount() const {
+    return isMapped() ? mappedTimeCount : timeStamps.size();
+}
+
+uint64_t SegmentIndex::timeEntryTimestamp(uint32_t entry) const {
+    return isMapped() ? readU64(mappedTimeEntries + entry * TIME_ENTRY_SIZE) : timeStamps[entry];
+}
+
+uint32_t SegmentIndex::timeEntryOffset(uint32_t entry) const {
+    return isMapped() ? readU32(mappedTimeEntries + entry * TIME_ENTRY_SIZE + 8) : timeOffsets[entry];
+}
+
+uint32_t SegmentIndex::postingCount(uint8_t address) const {
+    return isMapped() ? readU32(mappedDirectory + address * 8 + 4) : postingLists[address].size();
+}
+
+uint32_t SegmentIndex::posting(uint8_t address, uint32_t position) const {
+    if (isMapped()) {
+        uint32_t start = readU32(mappedDirectory + address * 8);
+        return readU32(mappedPostings + (size_t)(start + position) * 4);
+    }
+    return postingLists[address][position];
+}
+
+// --- CaptureStoreWriter ---
+
+CaptureStoreWriter::CaptureStoreWriter()
+    : segmentLimit(DEFAULT_SEGMENT_SIZE), segmentFile(nullptr), segmentNumber(0), segmentLength(0),
+      haveTimestamp(false), newCapture(true), lastRawTimestamp(0), lastSequence(0), timestampEpoch(0),
+      lastStoredTimestamp(0), recordCount(0) {
+}
+
+CaptureStoreWriter::~CaptureStoreWriter() {
+    close();
+}
+
+bool CaptureStoreWriter::open(const char* path, size_t segmentSize) {
+    close();
+    directory = path;
+    segmentLimit = std::min(std::max(segmentSize, (size_t)4096), MAX_SEGMENT_SIZE);
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        perror(path);
+        return false;
+    }
+
+    std::vector<uint32_t> numbers;
+    if (!CaptureStoreReader::listSegments(directory, numbers)) {
+        return false;
+    }
+
+    // Continue after the last segment, sealing any the previous writer left
+    // unindexed, and carry its timeline on
+    segmentNumber = 0;
+    haveTimestamp = false;
+    newCapture = true;
+    timestampEpoch = 0;
+    lastStoredTimestamp = 0;
+    for (uint32_t number : numbers) {
+        std::string indexPath = CaptureStoreReader::segmentPath(directory, number, ".idx");
+        if (access(indexPath.c_str(), F_OK) != 0 && !CaptureStoreReader::indexSegment(directory, number)) {
+            fprintf(stderr, "%s: cannot write index\n", indexPath.c_str());
+            return false;
+        }
+    }
+    if (!numbers.empty()) {
+        CaptureStoreReader existing;
+        if (!existing.open(path)) {
+            return false;
+        }
+        if (existing.getRecordCount() > 0) {
+            uint64_t last = existing.getLastTimestamp();
+            haveTimestamp = true;
+            lastRawTimestamp = (uint32_t)last;
+            timestampEpoch = last - lastRawTimestamp;
+            lastStoredTimestamp = last;
+        }
+        segmentNumber = numbers.back() + 1;
+    }
+    return true;
+}
+
+uint64_t CaptureStoreWriter::unwrap(uint32_t timestamp, uint16_t sequence) {
+    bool firstOfCapture = newCapture;
+    bool sequenceRestarted = haveTimestamp && !firstOfCapture &&
+                             sequence != (uint16_t)(lastSequence + 1) && sequence < lastSequence;
+    newCapture = false;
+    lastSequence = sequence;
+
+    if (!haveTimestamp) {
+        haveTimestamp = true;
+    } else if (timestamp < lastRawTimestamp) {
+        uint32_t step = lastRawTimestamp - timestamp;
+        if (step > 0x80000000u) {
+            timestampEpoch += 1ULL << 32;
+        } else if (firstOfCapture || sequenceRestarted || step > REBOOT_STEP_US) {
+            // A new device epoch (a reboot, or a fresh capture appended to
+            // the store) carries on from the last stored time
+            timestampEpoch = lastStoredTimestamp - timestamp;
+        } else {
+            // Summary frames and other buses can arrive a little out of
+            // order; hold them at the last stored time so the index and
+            // posting searches still see sorted times
+            return lastStoredTimestamp;
+        }
+    }
+    lastRawTimestamp = timestamp;
+    lastStoredTimestamp = timestampEpoch + timestamp;
+    return lastStoredTimestamp;
+}
+
+bool CaptureStoreWriter::startSegment() {
+    std::string path = CaptureStoreReader::segmentPath(directory, segmentNumber, ".rec");
+    segmentFile = fopen(path.c_str(), "wb");
+    if (!segmentFile) {
+        perror(path.c_str());
+        return false;
+    }
+    static char buffer[1 << 20];
+    setvbuf(segmentFile, buffer, _IOFBF, sizeof(buffer));
+    segmentLength = 0;
+    index.clear();
+    return true;
+}
+
+bool CaptureStoreWriter::sealSegment() {
+    if (!segmentFile) {
+        return true;
+    }
+
+    bool ok = fclose(segmentFile) == 0;
+    segmentFile = nullptr;
+    std::string path = CaptureStoreReader::segmentPath(directory, segmentNumber, ".idx");
+    ok = index.write(path.c_str()) && ok;
+    segmentNumber++;
+    return ok;
+}
+
+bool CaptureStoreWriter::append(const BinaryRecord& binary) {
+    if (!segmentFile && !startSegment()) {
+        return false;
+    }
+
+    uint8_t record[RECORD_HEADER_SIZE + I2CDecoder::MAX_DATA_SIZE];
+    StoredRecord stored;
+    stored.timestamp = unwrap(binary.timestamp, binary.sequence);
+    stored.sequence = binary.sequence;
+    stored.busId = binary.busId;
+
+    if (binary.type == RECORD_DROPPED) {
+        stored.address = 0;
+        stored.flags = STORE_FLAG_DROPPED;
+        stored.dataLength = 4;
+        writeU32(record + RECORD_HEADER_SIZE, binary.dropped);
+    } else {
+        stored.address = binary.address;
+        stored.flags = binary.flags & (RECORD_FLAG_READ | RECORD_FLAG_ERROR);
+        stored.dataLength = binary.dataLength;
+        memcpy(record + RECORD_HEADER_SIZE, binary.data, binary.dataLength);
+    }
+
+    writeU64(record, stored.timestamp);
+    writeU16(record + 8, stored.sequence);
+    record[10] = stored.busId;
+    record[11] = stored.address;
+    record[12] = stored.flags;
+    record[13] = stored.dataLength;
+
+    size_t length = RECORD_HEADER_SIZE + stored.dataLength;
+    if (fwrite(record, 1, length, segmentFile) != length) {
+        return false;
+    }
+    index.add(segmentLength, stored);
+    segmentLength += length;
+    recordCount++;
+
+    if (segmentLength >= segmentLimit) {
+        return sealSegment();
+    }
+    return true;
+}
+
+bool CaptureStoreWriter::flush() {
+    return !segmentFile || fflush(segmentFile) == 0;
+}
+
+bool CaptureStoreWriter::close() {
+    return sealSegment();
+}
+
+unsigned long long CaptureStoreWriter::getRecordCount() const {
+    return recordCount;
+}
+
+uint32_t CaptureStoreWriter::getSegmentCount() const {
+    return segmentNumber + (segmentFile ? 1 : 0);
+}
+
+// --- CaptureStoreReader ---
+
+CaptureStoreReader::CaptureStoreReader() {
+}
+
+CaptureStoreReader::~CaptureStoreReader() {
+    close();
+}
+
+std::string CaptureStoreReader::segmentPath(const std::string& directory, uint32_t number, const char* extension) {
+    char name[32];
+    snprintf(name, sizeof(name), "/segment-%06u%s", number, extension);
+    return directory + name;
+}
+
+bool CaptureStoreReader::listSegments(const std::string& directory, std::vector<uint32_t>& numbers) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        perror(directory.c_str());
+        return false;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        unsigned number;
+        char extension[8];
+        if (sscanf(entry->d_name, "segment-%6u.%3s", &number, extension) == 2 &&
+            strcmp(extension, "rec") == 0) {
+            numbers.push_back(number);
+        }
+    }
+    closedir(dir);
+    std::sort(numbers.begin(), numbers.end());
+    return true;
+}
+
+const uint8_t* CaptureStoreReader::mapFile(const std::string& path, size_t& length) {
+    length = 0;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        length = info.st_size;
+        mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapped == MAP_FAILED) {
+        length = 0;
+        return nullptr;
+    }
+    return static_cast<const uint8_t*>(mapped);
+}
+
+bool CaptureStoreReader::readRecord(const uint8_t* data, size_t length, uint32_t offset,
+                                    StoredRecord& record, uint32_t& next) {
+    if (offset + RECORD_HEADER_SIZE > length) {
+        return false;
+    }
+
+    const uint8_t* header = data + offset;
+    uint8_t dataLength = header[13];
+    if (offset + RECORD_HEADER_SIZE + dataLength > length || dataLength > I2CDecoder::MAX_DATA_SIZE) {
+        return false;
+    }
+
+    record.timestamp = readU64(header);
+    record.sequence = readU16(header + 8);
+    record.busId = header[10];
+    record.address = header[11];
+    record.flags = header[12];
+    record.dataLength = dataLength;
+    record.data = header + RECORD_HEADER_SIZE;
+    next = offset + RECORD_HEADER_SIZE + dataLength;
+    return true;
+}
+
+void CaptureStoreReader::scanSegment(const uint8_t* data, size_t length, SegmentIndex& index) {
+    index.clear();
+    StoredRecord record;
+    uint32_t offset = 0;
+    uint32_t next;
+    while (readRecord(data, length, offset, record, next)) {
+        index.add(offset, record);
+        offset = next;
+    }
+}
+
+bool CaptureStoreReader::indexSegment(const std::string& directory, uint32_t number) {
+    size_t length;
+    const uint8_t* data = mapFile(segmentPath(directory, number, ".rec"), length);
+
+    SegmentIndex index;
+    if (data) {
+        scanSegment(data, length, index);
+        munmap(const_cast<uint8_t*>(data), length);
+    }
+    return index.write(segmentPath(directory, number, ".idx").c_str());
+}
+
+bool CaptureStoreReader::open(const char* path) {
+    close();
+    std::string directory = path;
+    std::vector<uint32_t> numbers;
+    if (!listSegments(directory, numbers)) {
+        return false;
+    }
+
+    for (uint32_t number : numbers) {
+        Segment* segment = new Segment();
+        segment->number = number;
+        segment->data = mapFile(segmentPath(directory, number, ".rec"), segment->length);
+        segment->indexData = mapFile(segmentPath(directory, number, ".idx"), segment->indexLength);
+        segment->scanned = !segment->indexData ||
+                           !segment->index.attach(segment->indexData, segment->indexLength);
+        if (segment->scanned) {
+            scanSegment(segment->data, segment->length, segment->index);
+        }
+        segments.push_back(segment);
+    }
+    return true;
+}
+
+void CaptureStoreReader::close() {
+    for (Segment* segment : segments) {
+        if (segment->data) {
+            munmap(const_cast<uint8_t*>(segment->data), segment->length);
+        }
+        if (segment->indexData) {
+            munmap(const_cast<uint8_t*>(segment->indexData), segment->indexLength);
+        }
+        delete segment;
+    }
+    segments.clear();
+}
+
+bool CaptureStoreReader::matches(const StoredRecord& record, const CaptureQuery& query) {
+    if (record.timestamp < query.from || record.timestamp > query.to) {
+        return false;
+    }
+    if (query.address >= 0 && (record.address != query.address || (record.flags & STORE_FLAG_DROPPED))) {
+        return false;
+    }
+    if (query.busId >= 0 && record.busId != query.busId) {
+        return false;
+    }
+    if (query.direction >= 0 && (bool)(record.flags & STORE_FLAG_READ) != (query.direction == 1)) {
+        return false;
+    }
+    return true;
+}
+
+unsigned long long CaptureStoreReader::querySegment(const Segment& segment, const CaptureQuery& query,
+                                                    RecordHandler handler, void* context) const {
+    const SegmentIndex& index = segment.index;
+    unsigned long long count = 0;
+    StoredRecord record;
+    uint32_t next;
+
+    if (query.address >= 0) {
+        // Postings are in time order: binary search for the first record at
+        // or after 'from', then walk the address's records only
+        uint8_t address = query.address & 0x7F;
+        uint32_t low = 0;
+        uint32_t high = index.postingCount(address);
+        while (low < high) {
+            uint32_t middle = low + (high - low) / 2;
+            if (readRecord(segment.data, segment.length, index.posting(address, middle), record, next) &&
+                record.timestamp < query.from) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        for (uint32_t position = low; position < index.postingCount(address); position++) {
+            if (!readRecord(segment.data, segment.length, index.posting(address, position), record, next) ||
+                record.timestamp > query.to) {
+                break;
+            }
+            if (matches(record, query)) {
+                handler(context, record);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Start from the last time entry before 'from' and scan forward
+    uint32_t entries = index.timeEntryCount();
+    uint32_t low = 0;
+    uint32_t high = entries;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (index.timeEntryTimestamp(middle) < query.from) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    uint32_t offset = low > 0 ? index.timeEntryOffset(low - 1) : 0;
+    while (readRecord(segment.data, segment.length, offset, record, next)) {
+        if (record.timestamp > query.to) {
+            break;
+        }
+        if (matches(record, query)) {
+            handler(context, record);
+            count++;
+        }
+        offset = next;
+    }
+    return count;
+}
+
+unsigned long long CaptureStoreReader::query(const CaptureQuery& query, RecordHandler handler, void* context) const {
+    unsigned long long count = 0;
+    for (const Segment* segment : segments) {
+        const SegmentIndex& index = segment->index;
+        if (!segment->data || index.recordCount == 0 ||
+            index.lastTimestamp < query.from || index.firstTimestamp > query.to) {
+            continue;
+        }
+        count += querySegment(*segment, query, handler, context);
+    }
+    return count;
+}
+
+size_t CaptureStoreReader::getSegmentCount() const {
+    return segments.size();
+}
+
+unsigned long long CaptureStoreReader::getRecordCount() const {
+    unsigned long long count = 0;
+    for (const Segment* segment : segments) {
+        count += segment->index.recordCount;
+    }
+    return count;
+}
+
+size_t CaptureStoreReader::getUnindexedSegmentCount() const {
+    size_t count = 0;
+    for (const Segment* segment : segments) {
+        count += segment->scanned ? 1 : 0;
+    }
+    return count;
+}
+
+uint64_t CaptureStoreReader::getFirstTimestamp() const {
+    for (const Segment* segment : segments) {
+        if (segment->index.recordCount > 0) {
+            return segment->index.firstTimestamp;
+        }
+    }
+    return 0;
+}
+
+uint64_t CaptureStoreReader::getLastTimestamp() const {
+    for (size_t i = segments.size(); i > 0; i--) {
+        if (segments[i - 1]->index.recordCount > 0) {
+            return segments[i - 1]->index.lastTimestamp;
+        }
+    }
+    return 0;
+}
+
+// --- CaptureExport ---
+
+void CaptureExport::writeCsvHeader(FILE* output) {
+    fprintf(output, "timestamp_us,sequence,bus,address,direction,error,data\n");
+}
+
+// Same columns as i2c_frame_capture
+void CaptureExport::writeCsv(FILE* output, const StoredRecord& record) {
+    if (record.flags & STORE_FLAG_DROPPED) {
+        fprintf(output, "%llu,%u,%u,dropped,,,%u\n", (unsigned long long)record.timestamp,
+                record.sequence, record.busId, readU32(record.data));
+        return;
+    }
+
+    char hex[I2CDecoder::MAX_DATA_SIZE * 2 + 1];
+    for (uint8_t i = 0; i < record.dataLength; i++) {
+        snprintf(hex + i * 2, 3, "%02X", record.data[i]);
+    }
+    hex[record.dataLength * 2] = '\0';
+
+    fprintf(output, "%llu,%u,%u,0x%02X,%c,%d,%s\n",
+            (unsigned long long)record.timestamp, record.sequence, record.busId, record.address,
+            (record.flags & STORE_FLAG_READ) ? 'R' : 'W', (record.flags & STORE_FLAG_ERROR) ? 1 : 0, hex);
+}
+
+void CaptureExport::writePcapHeader(FILE* output) {
+    uint8_t header[24];
+    writeU32(header, 0xA1B2C3D4);  // Microsecond timestamps
+    writeU16(header + 4, 2);
+    writeU16(header + 6, 4);
+    writeU32(header + 8, 0);
+    writeU32(header + 12, 0);
+    writeU32(header + 16, 65535);
+    writeU32(header + 20, LINKTYPE_I2C_LINUX);
+    fwrite(header, 1, sizeof(header), output);
+}
+
+// DLT_I2C_LINUX packet: bus u8 | flags u32 BE (bit 0 = read) | address << 1 | read | data.
+// Timestamps are device time since boot, not wall clock. Drop markers have no
+// I2C equivalent and are left out.
+void CaptureExport::writePcap(FILE* output, const StoredRecord& record) {
+    if (record.flags & STORE_FLAG_DROPPED) {
+        return;
+    }
+
+    bool isRead = record.flags & STORE_FLAG_READ;
+    uint8_t packet[16 + 5 + 1 + I2CDecoder::MAX_DATA_SIZE];
+    uint32_t packetLength = 5 + 1 + record.dataLength;
+
+    writeU32(packet, (uint32_t)(record.timestamp / 1000000));
+    writeU32(packet + 4, (uint32_t)(record.timestamp % 1000000));
+    writeU32(packet + 8, packetLength);
+    writeU32(packet + 12, packetLength);
+
+    uint8_t* body = packet + 16;
+    body[0] = record.busId & 0x7F;
+    body[1] = 0;
+    body[2] = 0;
+    body[3] = 0;
+    body[4] = isRead ? 0x01 : 0x00;
+    body[5] = (record.address << 1) | (isRead ? 1 : 0);
+    memcpy(body + 6, record.data, record.dataLength);
+    fwrite(packet, 1, 16 + packetLength, output);
+}
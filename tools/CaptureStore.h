@@ -0,0 +1,193 @@
+#ifndef CAPTURE_STORE_H
+#define CAPTURE_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "BinaryFrame.h"
+
+// Host-side store for long captures. A store is a directory of segments:
+//
+//   segment-NNNNNN.rec  records, appended in arrival order
+//   segment-NNNNNN.idx  written when the segment is sealed
+//
+// Record: timestamp us (u64) | sequence (u16) | bus | address | flags | length | data[length]
+// Index:  magic | version | record count | first/last timestamp | time entry count
+//         | time entries {timestamp u64, offset u32} (one per TIME_INDEX_INTERVAL records)
+//         | posting directory {start u32, count u32}[128] | postings (record offsets, u32)
+//
+// All fields are little-endian. Device timestamps are 32-bit micros(); the
+// writer unwraps them into a 64-bit timeline so they stay non-decreasing
+// across the ~71 minute wrap. A device reboot (frame sequence restarting, or
+// time stepping back more than REBOOT_STEP_US) and a capture appended to an
+// existing store carry on from the last stored time; small reorderings are
+// held at it. Segments are memory-mapped for queries; a
+// segment without an index (still being written, or the writer died) is
+// indexed by a scan when the store is opened.
+
+enum StoreRecordFlags {
+    STORE_FLAG_READ = RECORD_FLAG_READ,
+    STORE_FLAG_ERROR = RECORD_FLAG_ERROR,
+    STORE_FLAG_DROPPED = 0x80  // Device dropped transactions; data holds the count (u32)
+};
+
+struct StoredRecord {
+    uint64_t timestamp;
+    uint16_t sequence;
+    uint8_t busId;
+    uint8_t address;
+    uint8_t flags;
+    uint8_t dataLength;
+    const uint8_t* data;
+};
+
+struct CaptureQuery {
+    uint64_t from;
+    uint64_t to;       // Inclusive
+    int address;       // -1 for any
+    int busId;         // -1 for any
+    int direction;     // -1 for any, 0 writes, 1 reads
+
+    CaptureQuery();
+};
+
+// In-memory index of one segment, either built while appending/scanning or
+// pointing into a mapped .idx file
+class SegmentIndex {
+public:
+    static const uint32_t MAGIC = 0x58433249;  // "I2CX"
+    static const uint32_t VERSION = 1;
+    static const uint32_t TIME_INDEX_INTERVAL = 256;
+    static const int ADDRESS_COUNT = 128;
+    static const size_t HEADER_SIZE = 32;
+    static const size_t TIME_ENTRY_SIZE = 12;
+
+    uint32_t recordCount;
+    uint64_t firstTimestamp;
+    uint64_t lastTimestamp;
+
+private:
+    // Built form
+    std::vector<uint64_t> timeStamps;
+    std::vector<uint32_t> timeOffsets;
+    std::vector<uint32_t> postingLists[ADDRESS_COUNT];
+
+    // Mapped form
+    const uint8_t* mappedTimeEntries;
+    uint32_t mappedTimeCount;
+    const uint8_t* mappedDirectory;
+    const uint8_t* mappedPostings;
+
+public:
+    SegmentIndex();
+    void clear();
+    void add(uint32_t offset, const StoredRecord& record);
+    bool attach(const uint8_t* data, size_t length);  // Mapped .idx contents
+    bool write(const char* path) const;
+
+    uint32_t timeEntryCount() const;
+    uint64_t timeEntryTimestamp(uint32_t entry) const;
+    uint32_t timeEntryOffset(uint32_t entry) const;
+    uint32_t postingCount(uint8_t address) const;
+    uint32_t posting(uint8_t address, uint32_t position) const;
+
+private:
+    bool isMapped() const;
+};
+
+class CaptureStoreWriter {
+public:
+    static const size_t DEFAULT_SEGMENT_SIZE = 64UL << 20;
+    static const size_t MAX_SEGMENT_SIZE = 1UL << 31;  // Offsets are u32
+    static const uint32_t REBOOT_STEP_US = 1000000;     // Larger steps back are a new device epoch
+
+private:
+    std::string directory;
+    size_t segmentLimit;
+    FILE* segmentFile;
+    uint32_t segmentNumber;
+    uint32_t segmentLength;
+    SegmentIndex index;
+
+    bool haveTimestamp;
+    bool newCapture;                // Next record starts this writer's capture
+    uint32_t lastRawTimestamp;
+    uint16_t lastSequence;
+    uint64_t timestampEpoch;
+    uint64_t lastStoredTimestamp;
+    unsigned long long recordCount;
+
+public:
+    CaptureStoreWriter();
+    ~CaptureStoreWriter();
+    bool open(const char* path, size_t segmentSize = DEFAULT_SEGMENT_SIZE);  // Appends to an existing store
+    bool append(const BinaryRecord& record);
+    bool flush();  // Pushes buffered records to the open segment
+    bool close();
+    unsigned long long getRecordCount() const;
+    uint32_t getSegmentCount() const;
+
+private:
+    bool startSegment();
+    bool sealSegment();
+    uint64_t unwrap(uint32_t timestamp, uint16_t sequence);
+};
+
+class CaptureStoreReader {
+public:
+    typedef void (*RecordHandler)(void* context, const StoredRecord& record);
+
+private:
+    struct Segment {
+        uint32_t number;
+        const uint8_t* data;
+        size_t length;
+        const uint8_t* indexData;
+        size_t indexLength;
+        bool scanned;  // No .idx on disk; index built from the records
+        SegmentIndex index;
+    };
+
+    std::vector<Segment*> segments;
+
+public:
+    CaptureStoreReader();
+    ~CaptureStoreReader();
+    bool open(const char* path);
+    void close();
+
+    unsigned long long query(const CaptureQuery& query, RecordHandler handler, void* context) const;
+    size_t getSegmentCount() const;
+    unsigned long long getRecordCount() const;
+    size_t getUnindexedSegmentCount() const;
+    uint64_t getFirstTimestamp() const;
+    uint64_t getLastTimestamp() const;
+
+    // Shared with the writer: parse the record at offset, false at a torn tail
+    static bool readRecord(const uint8_t* data, size_t length, uint32_t offset, StoredRecord& record, uint32_t& next);
+    static std::string segmentPath(const std::string& directory, uint32_t number, const char* extension);
+    static bool listSegments(const std::string& directory, std::vector<uint32_t>& numbers);
+    static void scanSegment(const uint8_t* data, size_t length, SegmentIndex& index);
+    static bool indexSegment(const std::string& directory, uint32_t number);  // Writes a missing .idx
+
+private:
+    unsigned long long querySegment(const Segment& segment, const CaptureQuery& query,
+                                    RecordHandler handler, void* context) const;
+    static bool matches(const StoredRecord& record, const CaptureQuery& query);
+    static const uint8_t* mapFile(const std::string& path, size_t& length);
+};
+
+// Export formats for query results
+class CaptureExport {
+public:
+    static const uint32_t LINKTYPE_I2C_LINUX = 209;
+
+    static void writeCsvHeader(FILE* output);
+    static void writeCsv(FILE* output, const StoredRecord& record);
+    static void writePcapHeader(FILE* output);
+    static void writePcap(FILE* output, const StoredRecord& record);
+};
+
+#endif
@@ -0,0 +1,258 @@
+// Compression benchmark for the BLE transaction stream (firmware COMPRESS ON).
+//
+// Runs a recorded binary USB capture (OUTPUT BINARY) or a synthetic sensor
+// workload through CompressedBlockWriter, checks the round trip through
+// CompressedStreamReader and reports the size against the text and binary
+// encodings along with the encode and decode cost.
+//
+// Build: g++ -std=c++17 -O2 -Isrc tools/i2c_compress_bench.cpp src/CompressedStream.cpp src/BinaryFrame.cpp -o i2c_compress_bench
+// Usage: i2c_compress_bench [--block 182] [--synthetic 100000 | capture.bin]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include "BinaryFrame.h"
+#include "CompressedStream.h"
+
+struct CapturedTransaction {
+    uint32_t timestamp;
+    uint8_t busId;
+    uint8_t address;
+    bool isRead;
+    bool hasError;
+    uint8_t length;
+    uint8_t data[I2CDecoder::MAX_DATA_SIZE];
+};
+
+struct VerifySession {
+    const std::vector<CapturedTransaction>* expected;
+    size_t next;
+    unsigned long mismatches;
+};
+
+static I2CTransaction toTransaction(CapturedTransaction& captured) {
+    I2CTransaction transaction;
+    transaction.address = captured.address;
+    transaction.isRead = captured.isRead;
+    transaction.data = captured.data;
+    transaction.dataLength = captured.length;
+    transaction.timestamp = captured.timestamp;
+    transaction.endTimestamp = captured.timestamp;
+    transaction.hasError = captured.hasError;
+    transaction.busId = captured.busId;
+    return transaction;
+}
+
+static void onRecord(void* context, const BinaryRecord& record) {
+    std::vector<CapturedTransaction>* transactions = static_cast<std::vector<CapturedTransaction>*>(context);
+    if (record.type != RECORD_TRANSACTION) {
+        return;
+    }
+
+    CapturedTransaction captured;
+    captured.timestamp = record.timestamp;
+    captured.busId = record.busId;
+    captured.address = record.address;
+    captured.isRead = record.flags & RECORD_FLAG_READ;
+    captured.hasError = record.flags & RECORD_FLAG_ERROR;
+    captured.length = record.dataLength;
+    memcpy(captured.data, record.data, record.dataLength);
+    transactions->push_back(captured);
+}
+
+static bool loadCapture(const char* path, std::vector<CapturedTransaction>& transactions) {
+    FILE* input = fopen(path, "rb");
+    if (!input) {
+        perror(path);
+        return false;
+    }
+
+    BinaryFrameReader reader;
+    reader.setRecordHandler(onRecord, &transactions);
+
+    uint8_t chunk[16384];
+    size_t length;
+    while ((length = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+        reader.feed(chunk, length);
+    }
+    fclose(input);
+    return true;
+}
+
+// Polled sensors: a temperature sensor read through its pointer register, an
+// IMU burst-read at 1 kHz with a noisy low byte, and occasional EEPROM writes.
+static void generateSynthetic(size_t count, std::vector<CapturedTransaction>& transactions) {
+    uint32_t timestamp = 4294000000u;  // Exercise micros() wraparound
+    uint32_t seed = 12345;
+    while (transactions.size() < count) {
+        seed = seed * 1103515245 + 12345;
+        CapturedTransaction captured = {};
+        timestamp += 900 + (seed >> 16) % 200;
+        captured.timestamp = timestamp;
+
+        switch ((seed >> 8) % 10) {
+            case 0:
+            case 1:
+                captured.address = 0x48;
+                captured.length = 1;
+                captured.data[0] = 0x00;
+                transactions.push_back(captured);
+                captured.timestamp += 120;
+                captured.isRead = true;
+                captured.length = 2;
+                captured.data[0] = 0x19;
+                captured.data[1] = (seed >> 24) % 3 == 0 ? 0x80 : 0x70;
+                break;
+            case 9:
+                captured.address = 0x50;
+                captured.length = 9;
+                captured.data[0] = (seed >> 12) & 0xF8;
+                for (int i = 1; i < 9; i++) {
+                    captured.data[i] = (seed >> i) & 0xFF;
+                }
+                break;
+            default:
+                captured.address = 0x68;
+                captured.busId = 1;
+                captured.isRead = true;
+                captured.length = 6;
+                captured.data[0] = 0x3B;
+                captured.data[1] = 0xFF;
+                captured.data[2] = 0x00;
+                captured.data[3] = 0x40;
+                captured.data[4] = 0x00;
+                captured.data[5] = (seed >> 20) % 4;
+                break;
+        }
+        transactions.push_back(captured);
+    }
+}
+
+static size_t textSize(const CapturedTransaction& captured) {
+    // Same layout as I2CFormatter::formatTransaction with FORMAT HEX
+    char line[256];
+    int length = snprintf(line, sizeof(line), "%u [%s0x%02X] ", captured.timestamp,
+                          captured.busId ? "1:" : "", captured.address);
+    if (captured.hasError) {
+        return length + 6;
+    }
+    return length + 3 + (captured.length ? captured.length * 5 - 1 : 3) + 1;
+}
+
+static double secondsSince(const struct timespec& start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static void verifyTransaction(void* context, const I2CTransaction& transaction) {
+    VerifySession* session = static_cast<VerifySession*>(context);
+    if (session->next >= session->expected->size()) {
+        session->mismatches++;
+        return;
+    }
+
+    const CapturedTransaction& expected = (*session->expected)[session->next++];
+    if (transaction.timestamp != expected.timestamp || transaction.address != expected.address ||
+        transaction.isRead != expected.isRead || transaction.hasError != expected.hasError ||
+        transaction.busId != expected.busId || transaction.dataLength != expected.length ||
+        memcmp(transaction.data, expected.data, expected.length) != 0) {
+        session->mismatches++;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* inputPath = nullptr;
+    size_t syntheticCount = 0;
+    size_t blockLimit = 182;  // Notification payload at the firmware's preferred MTU
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--synthetic") == 0 && i + 1 < argc) {
+            syntheticCount = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--block") == 0 && i + 1 < argc) {
+            blockLimit = strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [--block bytes] [--synthetic count | capture.bin]\n", argv[0]);
+            return 2;
+        } else {
+            inputPath = argv[i];
+        }
+    }
+
+    std::vector<CapturedTransaction> transactions;
+    if (inputPath) {
+        if (!loadCapture(inputPath, transactions)) {
+            return 1;
+        }
+    } else {
+        generateSynthetic(syntheticCount ? syntheticCount : 100000, transactions);
+    }
+    if (transactions.empty()) {
+        fprintf(stderr, "no transactions in input\n");
+        return 1;
+    }
+
+    size_t textBytes = 0;
+    size_t binaryBytes = 0;
+    BinaryFrameWriter frameWriter;
+    uint8_t frame[BinaryFrame::MAX_FRAME_SIZE];
+    for (CapturedTransaction& captured : transactions) {
+        textBytes += textSize(captured);
+        binaryBytes += frameWriter.encodeTransaction(toTransaction(captured), frame);
+    }
+
+    // Encode: keep the blocks for the round trip check
+    static CompressedBlockWriter writer;
+    writer.setBlockLimit(blockLimit);
+    std::vector<std::vector<uint8_t>> blocks;
+    size_t compressedBytes = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (CapturedTransaction& captured : transactions) {
+        I2CTransaction transaction = toTransaction(captured);
+        if (!writer.append(transaction)) {
+            size_t length = writer.finish();
+            blocks.emplace_back(writer.data(), writer.data() + length);
+            compressedBytes += length;
+            writer.append(transaction);
+        }
+    }
+    if (!writer.isEmpty()) {
+        size_t length = writer.finish();
+        blocks.emplace_back(writer.data(), writer.data() + length);
+        compressedBytes += length;
+    }
+    double encodeSeconds = secondsSince(start);
+
+    VerifySession session = {&transactions, 0, 0};
+    static CompressedStreamReader reader;
+    reader.setTransactionHandler(verifyTransaction, &session);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (const std::vector<uint8_t>& block : blocks) {
+        reader.feedBlock(block.data(), block.size());
+    }
+    double decodeSeconds = secondsSince(start);
+
+    size_t count = transactions.size();
+    printf("transactions:      %zu\n", count);
+    printf("text (FORMAT HEX): %zu bytes, %zu notifications\n", textBytes, count);
+    printf("binary frames:     %zu bytes\n", binaryBytes);
+    printf("compressed:        %zu bytes, %zu notifications of <= %zu bytes\n",
+           compressedBytes, blocks.size(), blockLimit);
+    printf("ratio:             %.2fx vs text, %.2fx vs binary, %.2f bytes/transaction\n",
+           (double)textBytes / compressedBytes, (double)binaryBytes / compressedBytes,
+           (double)compressedBytes / count);
+    printf("encode:            %.1f ns/transaction, %.2f ns/binary byte\n",
+           encodeSeconds * 1e9 / count, encodeSeconds * 1e9 / binaryBytes);
+    printf("decode:            %.1f ns/transaction\n", decodeSeconds * 1e9 / count);
+    printf("round trip:        %s (%zu decoded, %lu mismatches, %lu corrupt, %lu lost blocks)\n",
+           session.mismatches == 0 && session.next == count ? "OK" : "FAILED",
+           session.next, session.mismatches, reader.getCorruptBlockCount(), reader.getLostBlockCount());
+
+    return session.mismatches == 0 && session.next == count ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+// Host-side decoder for raw edge captures (firmware MODE RAW).
+//
+// Replays the captured SDA/SCL edges through the same I2CDecoder the firmware
+// uses, prints the decoded transactions and optionally exports a VCD trace.
+//
+// Build: g++ -std=c++17 -O2 -Isrc tools/i2c_edge_decode.cpp src/I2CDecoder.cpp src/EdgeStream.cpp -o i2c_edge_decode
+// Usage: i2c_edge_decode [--vcd trace.vcd] [capture.bin | /dev/ttyACM0]   (stdin when omitted)
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "I2CDecoder.h"
+#include "EdgeStream.h"
+
+struct DecodeSession {
+    I2CDecoder decoder;
+    FILE* vcd;
+    bool haveFirstEvent;
+    uint32_t lastTimestamp;
+    uint64_t elapsedMicros;
+    bool lastSCL;
+    bool lastSDA;
+    unsigned long edgeCount;
+    unsigned long transactionCount;
+    unsigned long droppedEdges;
+};
+
+static void writeVcdHeader(FILE* vcd) {
+    fprintf(vcd, "$timescale 1us $end\n");
+    fprintf(vcd, "$scope module i2c $end\n");
+    fprintf(vcd, "$var wire 1 ! scl $end\n");
+    fprintf(vcd, "$var wire 1 \" sda $end\n");
+    fprintf(vcd, "$var wire 1 # overrun $end\n");
+    fprintf(vcd, "$upscope $end\n");
+    fprintf(vcd, "$enddefinitions $end\n");
+    fprintf(vcd, "#0\n$dumpvars\n1!\n1\"\n0#\n$end\n");
+}
+
+static void onTransaction(void* context, const I2CTransaction& transaction) {
+    DecodeSession* session = static_cast<DecodeSession*>(context);
+    session->transactionCount++;
+
+    printf("%lu [0x%02X] ", transaction.timestamp, transaction.address);
+    if (transaction.hasError) {
+        printf("ERROR\n");
+        return;
+    }
+
+    printf("%s", transaction.isRead ? "R:" : "W:");
+    for (size_t i = 0; i < transaction.dataLength; i++) {
+        printf(" 0x%02X", transaction.data[i]);
+    }
+    printf("\n");
+}
+
+static void onEdge(void* context, const I2CEdgeEvent& event) {
+    DecodeSession* session = static_cast<DecodeSession*>(context);
+    bool scl = event.lines & EDGE_SCL;
+    bool sda = event.lines & EDGE_SDA;
+
+    // Device timestamps are 32-bit micros(); unwrap them for the VCD timeline
+    if (session->haveFirstEvent) {
+        session->elapsedMicros += (uint32_t)(event.timestamp - session->lastTimestamp);
+    }
+    session->haveFirstEvent = true;
+    session->lastTimestamp = event.timestamp;
+    session->edgeCount++;
+
+    if (event.lines & EDGE_FROM_SDA) {
+        session->decoder.handleSDAEdge(scl, sda, event.timestamp);
+    } else {
+        session->decoder.handleSCLEdge(scl, sda, event.timestamp);
+    }
+
+    if (session->vcd && (scl != session->lastSCL || sda != session->lastSDA)) {
+        fprintf(session->vcd, "#%llu\n", (unsigned long long)session->elapsedMicros);
+        if (scl != session->lastSCL) {
+            fprintf(session->vcd, "%d!\n", scl ? 1 : 0);
+        }
+        if (sda != session->lastSDA) {
+            fprintf(session->vcd, "%d\"\n", sda ? 1 : 0);
+        }
+    }
+    session->lastSCL = scl;
+    session->lastSDA = sda;
+}
+
+static void onOverrun(void* context, uint32_t droppedEdges) {
+    DecodeSession* session = static_cast<DecodeSession*>(context);
+    session->droppedEdges += droppedEdges;
+
+    // Edges are missing, so whatever transaction was in flight is garbage
+    session->decoder.reset();
+    fprintf(stderr, "overrun: %u edges dropped on device\n", (unsigned)droppedEdges);
+
+    if (session->vcd) {
+        fprintf(session->vcd, "#%llu\n1#\n", (unsigned long long)session->elapsedMicros);
+        fprintf(session->vcd, "#%llu\n0#\n", (unsigned long long)session->elapsedMicros + 1);
+    }
+}
+
+static int openInput(const char* path) {
+    if (!path) {
+        return STDIN_FILENO;
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    // USB CDC ignores the baud rate, but the line discipline must be raw
+    struct termios tty;
+    if (isatty(fd) && tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        tty.c_cc[VMIN] = 1;
+        tty.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    return fd;
+}
+
+int main(int argc, char** argv) {
+    const char* inputPath = nullptr;
+    const char* vcdPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--vcd") == 0 && i + 1 < argc) {
+            vcdPath = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "usage: %s [--vcd trace.vcd] [capture]\n", argv[0]);
+            return 2;
+        } else {
+            inputPath = argv[i];
+        }
+    }
+
+    int input = openInput(inputPath);
+    if (input < 0) {
+        return 1;
+    }
+
+    static DecodeSession session;
+    session.vcd = nullptr;
+    session.lastSCL = true;
+    session.lastSDA = true;
+    session.decoder.setTransactionHandler(onTransaction, &session);
+
+    if (vcdPath) {
+        session.vcd = fopen(vcdPath, "w");
+        if (!session.vcd) {
+            perror(vcdPath);
+            return 1;
+        }
+        writeVcdHeader(session.vcd);
+    }
+
+    static EdgeStreamReader reader;
+    reader.setHandlers(onEdge, onOverrun, &session);
+
+    uint8_t chunk[4096];
+    ssize_t length;
+    while ((length = read(input, chunk, sizeof(chunk))) > 0) {
+        reader.feed(chunk, length);
+        fflush(stdout);
+    }
+
+    if (session.vcd) {
+        fclose(session.vcd);
+    }
+    if (input != STDIN_FILENO) {
+        close(input);
+    }
+
+    fprintf(stderr, "%lu blocks, %lu edges, %lu transactions, %lu dropped edges, %lu corrupt blocks, %lu bytes skipped\n",
+            reader.getBlockCount(), session.edgeCount, session.transactionCount,
+            session.droppedEdges, reader.getCorruptBlockCount(), reader.getSkippedByteCount());
+    return 0;
+}
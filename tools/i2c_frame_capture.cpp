@@ -0,0 +1,163 @@
+// Host-side reader for the binary USB CDC stream (firmware OUTPUT BINARY).
+//
+// Reads COBS-framed records from a tty, file or pipe, validates CRCs and
+// sequence numbers, and writes the decoded transactions to disk as CSV.
+//
+// Build: g++ -std=c++17 -O2 -Isrc tools/i2c_frame_capture.cpp src/BinaryFrame.cpp -o i2c_frame_capture
+// Usage: i2c_frame_capture [-o capture.csv] [/dev/ttyACM0 | capture.bin]   (stdin when omitted)
+
+#include <stdio.h>
+#include <signal.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "BinaryFrame.h"
+
+struct CaptureSession {
+    FILE* output;
+    unsigned long droppedOnDevice;
+};
+
+static void onRecord(void* context, const BinaryRecord& record) {
+    CaptureSession* session = static_cast<CaptureSession*>(context);
+
+    if (record.type == RECORD_DROPPED) {
+        session->droppedOnDevice += record.dropped;
+        fprintf(session->output, "%u,%u,%u,dropped,,,%u\n",
+                record.timestamp, record.sequence, record.busId, record.dropped);
+        return;
+    }
+
+    char hex[I2CDecoder::MAX_DATA_SIZE * 2 + 1];
+    for (uint8_t i = 0; i < record.dataLength; i++) {
+        snprintf(hex + i * 2, 3, "%02X", record.data[i]);
+    }
+    hex[record.dataLength * 2] = '\0';
+
+    fprintf(session->output, "%u,%u,%u,0x%02X,%c,%d,%s\n",
+            record.timestamp, record.sequence, record.busId, record.address,
+            (record.flags & RECORD_FLAG_READ) ? 'R' : 'W',
+            (record.flags & RECORD_FLAG_ERROR) ? 1 : 0, hex);
+}
+
+static int openInput(const char* path) {
+    if (!path) {
+        return STDIN_FILENO;
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    // USB CDC ignores the baud rate, but the line discipline must be raw
+    struct termios tty;
+    if (isatty(fd) && tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        tty.c_cc[VMIN] = 1;
+        tty.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    return fd;
+}
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+// No SA_RESTART: a blocked read() returns EINTR so the loop can finish up
+static void installStopHandlers() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+static double secondsSince(const struct timespec& start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(int argc, char** argv) {
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "usage: %s [-o capture.csv] [input]\n", argv[0]);
+            return 2;
+        } else {
+            inputPath = argv[i];
+        }
+    }
+
+    int input = openInput(inputPath);
+    if (input < 0) {
+        return 1;
+    }
+
+    CaptureSession session;
+    session.droppedOnDevice = 0;
+    session.output = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!session.output) {
+        perror(outputPath);
+        return 1;
+    }
+    static char outputBuffer[1 << 20];
+    setvbuf(session.output, outputBuffer, _IOFBF, sizeof(outputBuffer));
+    fprintf(session.output, "timestamp_us,sequence,bus,address,direction,error,data\n");
+
+    BinaryFrameReader reader;
+    reader.setRecordHandler(onRecord, &session);
+    installStopHandlers();
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    double lastReport = 0;
+    unsigned long long totalBytes = 0;
+
+    uint8_t chunk[16384];
+    ssize_t length;
+    while (!stopRequested && (length = read(input, chunk, sizeof(chunk))) > 0) {
+        reader.feed(chunk, length);
+        totalBytes += length;
+
+        double elapsed = secondsSince(start);
+        if (elapsed - lastReport < 1.0) {
+            continue;
+        }
+        lastReport = elapsed;
+
+        // Flushed once a second so a killed capture loses at most that much
+        fflush(session.output);
+        if (outputPath) {
+            fprintf(stderr, "\r%lu records, %.1f KB/s, %lu bad frames, %lu lost, %lu dropped on device",
+                    reader.getRecordCount(), totalBytes / 1024.0 / elapsed,
+                    reader.getBadFrameCount(), reader.getLostRecordCount(), session.droppedOnDevice);
+        }
+    }
+
+    fflush(session.output);
+    if (session.output != stdout) {
+        fclose(session.output);
+    }
+    if (input != STDIN_FILENO) {
+        close(input);
+    }
+
+    fprintf(stderr, "\n%lu records, %llu bytes, %lu bad frames, %lu lost records, %lu dropped on device\n",
+            reader.getRecordCount(), totalBytes, reader.getBadFrameCount(),
+            reader.getLostRecordCount(), session.droppedOnDevice);
+    return 0;
+}
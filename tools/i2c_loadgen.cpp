@@ -0,0 +1,674 @@
+// Bus traffic generator and load harness for the sniffer's decode pipeline.
+//
+// Synthesizes SDA/SCL edge sequences for a set of scenarios (clock rates,
+// clock stretching, repeated STARTs, NACKs, long transfers, glitches, two
+// masters arbitrating) and feeds them through the same I2CDecoder and
+// AddressFilter the firmware runs, checking every decoded transaction against
+// what the generator put on the bus.
+//
+// With --sweep it searches for the highest bus clock the device pipeline
+// keeps up with. The device model delivers each edge as a GPIO interrupt that
+// samples both lines when it runs (edges arriving while one is pending merge
+// into it), stamps it with micros() and queues decoded transactions until the
+// main loop drains them, like I2CListener does. The loop wakes --wake-us after
+// a transaction lands in an empty queue, as EventLoop does; --loop-us models a
+// fixed polling period instead. Interrupt and loop timings are model
+// parameters; calibrate them against a scope trace of the board.
+//
+// Build: g++ -std=c++17 -O2 -Isrc tools/i2c_loadgen.cpp src/I2CDecoder.cpp src/AddressFilter.cpp -o i2c_loadgen
+// Usage: i2c_loadgen [--scenario name] [--sweep] [--isr-ns 2500] [--isr-latency-ns 1500]
+//                    [--wake-us 50 | --loop-us 10000] [--queue 15] [-v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include "I2CDecoder.h"
+#include "AddressFilter.h"
+
+struct BusEdge {
+    uint64_t timeNs;
+    bool scl;
+    bool sda;
+    bool fromSDA;
+};
+
+struct ExpectedTransaction {
+    uint8_t address;
+    bool isRead;
+    bool hasError;
+    std::vector<uint8_t> data;
+};
+
+struct DecodedTransaction {
+    uint8_t address;
+    bool isRead;
+    bool hasError;
+    uint32_t timestamp;
+    std::vector<uint8_t> data;
+};
+
+// Builds a bus waveform bit by bit. SDA only changes while SCL is low, except
+// for START/STOP and deliberate glitches.
+class BusBuilder {
+public:
+    std::vector<BusEdge> edges;
+    std::vector<ExpectedTransaction> expected;
+
+private:
+    uint64_t now;
+    uint32_t halfPeriodNs;
+    bool scl;
+    bool sda;
+
+public:
+    explicit BusBuilder(uint32_t clockHz) : now(10000), scl(true), sda(true) {
+        setClock(clockHz);
+    }
+
+    void setClock(uint32_t clockHz) {
+        halfPeriodNs = 500000000u / clockHz;
+    }
+
+    uint64_t time() const {
+        return now;
+    }
+
+    void idle(uint64_t ns) {
+        now += ns;
+    }
+
+    void setSCL(bool level) {
+        if (level != scl) {
+            scl = level;
+            edges.push_back({now, scl, sda, false});
+        }
+    }
+
+    void setSDA(bool level) {
+        if (level != sda) {
+            sda = level;
+            edges.push_back({now, scl, sda, true});
+        }
+    }
+
+    // START, or repeated START when the bus is mid-transfer
+    void start() {
+        if (!scl) {
+            now += halfPeriodNs / 2;
+            setSDA(true);
+            now += halfPeriodNs / 2;
+            setSCL(true);
+            now += halfPeriodNs;
+        }
+        setSDA(false);
+        now += halfPeriodNs;
+        setSCL(false);
+    }
+
+    void stop() {
+        now += halfPeriodNs / 2;
+        setSDA(false);
+        now += halfPeriodNs / 2;
+        setSCL(true);
+        now += halfPeriodNs;
+        setSDA(true);
+        now += halfPeriodNs * 2;  // Bus free time
+    }
+
+    // One clock: SDA settles mid-way through the low phase; a slave may hold
+    // SCL low for stretchNs before releasing it
+    void bit(bool level, uint32_t stretchNs = 0) {
+        now += halfPeriodNs / 2;
+        setSDA(level);
+        now += halfPeriodNs - halfPeriodNs / 2 + stretchNs;
+        setSCL(true);
+        now += halfPeriodNs;
+        setSCL(false);
+    }
+
+    void byte(uint8_t value, bool acked, uint32_t stretchNs = 0) {
+        for (int i = 7; i >= 0; i--) {
+            bit((value >> i) & 1);
+        }
+        bit(!acked, stretchNs);
+    }
+
+    // Pulse one line away from its level and back, widthNs later
+    void glitch(bool onSDA, uint32_t widthNs) {
+        if (onSDA) {
+            setSDA(!sda);
+            now += widthNs;
+            setSDA(!sda);
+        } else {
+            setSCL(!scl);
+            now += widthNs;
+            setSCL(!scl);
+        }
+    }
+
+    void write(uint8_t address, const std::vector<uint8_t>& data, uint32_t stretchNs = 0) {
+        start();
+        writePhase(address, data, stretchNs);
+        stop();
+    }
+
+    void read(uint8_t address, const std::vector<uint8_t>& data) {
+        start();
+        readPhase(address, data);
+        stop();
+    }
+
+    // Register read: pointer write, repeated START, read
+    void readRegister(uint8_t address, uint8_t reg, const std::vector<uint8_t>& data) {
+        start();
+        writePhase(address, {reg}, 0);
+        start();
+        readPhase(address, data);
+        stop();
+    }
+
+    void writePhase(uint8_t address, const std::vector<uint8_t>& data, uint32_t stretchNs) {
+        byte(address << 1, true, stretchNs);
+        for (uint8_t value : data) {
+            byte(value, true, stretchNs);
+        }
+        expect(address, false, data);
+    }
+
+    void readPhase(uint8_t address, const std::vector<uint8_t>& data) {
+        byte((address << 1) | 1, true);
+        for (size_t i = 0; i < data.size(); i++) {
+            byte(data[i], i + 1 < data.size());  // Master NACKs the last byte
+        }
+        expect(address, true, data);
+    }
+
+    void expect(uint8_t address, bool isRead, const std::vector<uint8_t>& data) {
+        ExpectedTransaction transaction = {address, isRead, false, data};
+        if (transaction.data.size() > (size_t)I2CDecoder::MAX_DATA_SIZE) {
+            transaction.data.resize(I2CDecoder::MAX_DATA_SIZE);  // Decoder keeps the first bytes
+        }
+        if (!transaction.data.empty()) {
+            expected.push_back(transaction);
+        }
+    }
+};
+
+struct PipelineResult {
+    std::vector<DecodedTransaction> decoded;
+    unsigned long edgesDelivered;
+    unsigned long edgesMerged;
+    unsigned long droppedTransactions;
+    unsigned long filteredTransactions;
+};
+
+struct PipelineSession {
+    AddressFilter* filter;
+    PipelineResult* result;
+    size_t queued;
+    size_t queueSize;
+};
+
+struct DeviceModel {
+    uint32_t isrNs;         // Time the handler keeps the CPU busy per edge
+    uint32_t isrLatencyNs;  // Edge to handler entry
+    uint32_t wakeNs;        // First queued transaction to drain
+    uint32_t loopNs;        // Polling period between drains instead, if non-zero
+    size_t queueSize;       // Usable transaction queue slots
+};
+
+// Same admission order as I2CListener::handleTransaction: filter, then queue
+static void onDecoded(void* context, const I2CTransaction& transaction) {
+    PipelineSession* session = static_cast<PipelineSession*>(context);
+    if (!session->filter->admit(transaction.address, transaction.timestamp)) {
+        session->result->filteredTransactions++;
+        return;
+    }
+    if (session->queued >= session->queueSize) {
+        session->result->droppedTransactions++;
+        return;
+    }
+
+    session->queued++;
+    DecodedTransaction decoded;
+    decoded.address = transaction.address;
+    decoded.isRead = transaction.isRead;
+    decoded.hasError = transaction.hasError;
+    decoded.timestamp = transaction.timestamp;
+    decoded.data.assign(transaction.data, transaction.data + transaction.dataLength);
+    session->result->decoded.push_back(decoded);
+}
+
+static uint32_t toMicros(uint64_t ns) {
+    return (uint32_t)(ns / 1000);
+}
+
+// Every edge reaches the decoder with the exact line levels
+static PipelineResult runIdeal(const std::vector<BusEdge>& edges, AddressFilter& filter) {
+    PipelineResult result = {};
+    PipelineSession session = {&filter, &result, 0, (size_t)-1};
+    I2CDecoder decoder;
+    decoder.setTransactionHandler(onDecoded, &session);
+
+    for (const BusEdge& edge : edges) {
+        if (edge.fromSDA) {
+            decoder.handleSDAEdge(edge.scl, edge.sda, toMicros(edge.timeNs));
+        } else {
+            decoder.handleSCLEdge(edge.scl, edge.sda, toMicros(edge.timeNs));
+        }
+        result.edgesDelivered++;
+    }
+    return result;
+}
+
+// Edges go through the interrupt and queue model described at the top
+static PipelineResult runDevice(const std::vector<BusEdge>& edges, AddressFilter& filter, const DeviceModel& model) {
+    PipelineResult result = {};
+    PipelineSession session = {&filter, &result, 0, model.queueSize};
+    I2CDecoder decoder;
+    decoder.setTransactionHandler(onDecoded, &session);
+
+    bool scl = true;
+    bool sda = true;
+    bool pending[2] = {false, false};  // SCL, SDA
+    uint64_t pendingSince[2] = {0, 0};
+    uint64_t cpuFreeAt = 0;
+    uint64_t nextDrain = model.loopNs ? model.loopNs : UINT64_MAX;
+    size_t next = 0;
+
+    while (true) {
+        // Next interrupt the CPU can take: the older pending pin first
+        int pin = -1;
+        uint64_t serviceAt = UINT64_MAX;
+        for (int i = 0; i < 2; i++) {
+            if (pending[i]) {
+                uint64_t at = pendingSince[i] + model.isrLatencyNs;
+                at = at > cpuFreeAt ? at : cpuFreeAt;
+                if (at < serviceAt) {
+                    serviceAt = at;
+                    pin = i;
+                }
+            }
+        }
+
+        uint64_t edgeAt = next < edges.size() ? edges[next].timeNs : UINT64_MAX;
+        if (pin < 0 && edgeAt == UINT64_MAX) {
+            break;
+        }
+
+        if (nextDrain <= edgeAt && nextDrain <= serviceAt) {
+            session.queued = 0;
+            nextDrain = model.loopNs ? nextDrain + model.loopNs : UINT64_MAX;
+            continue;
+        }
+
+        if (edgeAt <= serviceAt) {
+            const BusEdge& edge = edges[next++];
+            scl = edge.scl;
+            sda = edge.sda;
+            int edgePin = edge.fromSDA ? 1 : 0;
+            if (pending[edgePin]) {
+                result.edgesMerged++;
+            } else {
+                pending[edgePin] = true;
+                pendingSince[edgePin] = edge.timeNs;
+            }
+            continue;
+        }
+
+        // The handler reads both lines as they are now, not as they were at the edge
+        pending[pin] = false;
+        size_t queuedBefore = session.queued;
+        if (pin == 1) {
+            decoder.handleSDAEdge(scl, sda, toMicros(serviceAt));
+        } else {
+            decoder.handleSCLEdge(scl, sda, toMicros(serviceAt));
+        }
+        result.edgesDelivered++;
+        cpuFreeAt = serviceAt + model.isrNs;
+
+        // Empty to non-empty is what notifies the sleeping loop
+        if (!model.loopNs && queuedBefore == 0 && session.queued > 0) {
+            nextDrain = cpuFreeAt + model.wakeNs;
+        }
+    }
+    return result;
+}
+
+static bool compare(const std::vector<ExpectedTransaction>& expected, const PipelineResult& result,
+                    bool verbose, std::string& error) {
+    size_t count = expected.size() < result.decoded.size() ? expected.size() : result.decoded.size();
+    for (size_t i = 0; i < count; i++) {
+        const ExpectedTransaction& want = expected[i];
+        const DecodedTransaction& got = result.decoded[i];
+        if (want.address != got.address || want.isRead != got.isRead ||
+            want.hasError != got.hasError || want.data != got.data) {
+            char message[160];
+            snprintf(message, sizeof(message),
+                     "transaction %zu: expected 0x%02X %c %zu bytes%s, decoded 0x%02X %c %zu bytes%s",
+                     i, want.address, want.isRead ? 'R' : 'W', want.data.size(), want.hasError ? " error" : "",
+                     got.address, got.isRead ? 'R' : 'W', got.data.size(), got.hasError ? " error" : "");
+            error = message;
+            return false;
+        }
+    }
+    if (expected.size() != result.decoded.size()) {
+        char message[96];
+        snprintf(message, sizeof(message), "expected %zu transactions, decoded %zu (%lu dropped)",
+                 expected.size(), result.decoded.size(), result.droppedTransactions);
+        error = message;
+        return false;
+    }
+
+    if (verbose) {
+        for (const DecodedTransaction& got : result.decoded) {
+            printf("    %u [0x%02X] %s", got.timestamp, got.address, got.isRead ? "R:" : "W:");
+            for (uint8_t value : got.data) {
+                printf(" 0x%02X", value);
+            }
+            printf("%s\n", got.hasError ? " ERROR" : "");
+        }
+    }
+    return true;
+}
+
+// --- Scenarios ---
+
+typedef void (*ScenarioBuilder)(BusBuilder& bus, AddressFilter& filter);
+
+struct Scenario {
+    const char* name;
+    uint32_t clockHz;
+    ScenarioBuilder build;
+    const char* description;
+    const char* knownLimit;  // Expected to fail, and why; nullptr otherwise
+};
+
+static std::vector<uint8_t> pattern(size_t length, uint8_t seed) {
+    std::vector<uint8_t> data(length);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(seed + i * 37);
+    }
+    return data;
+}
+
+static void defaultFilter(AddressFilter& filter) {
+    filter.addRange(0x08, 0x77);
+}
+
+static void buildSensorPolling(BusBuilder& bus, AddressFilter& filter) {
+    defaultFilter(filter);
+    for (int i = 0; i < 50; i++) {
+        bus.readRegister(0x48, 0x00, {0x19, (uint8_t)(0x80 + i)});
+        bus.readRegister(0x68, 0x3B, pattern(6, i));
+        bus.write(0x50, {0x00, (uint8_t)i, 0xA5});
+    }
+}
+
+static void buildClockStretch(BusBuilder& bus, AddressFilter& filter) {
+    defaultFilter(filter);
+    for (int i = 0; i < 20; i++) {
+        bus.write(0x40, pattern(4, i), 50000);  // Slave holds SCL 50 us after every ACK
+        bus.readRegister(0x40, 0x10, pattern(3, i + 1));
+    }
+}
+
+static void buildNacks(BusBuilder& bus, AddressFilter& filter) {
+    defaultFilter(filter);
+    for (int i = 0; i < 10; i++) {
+        // Nobody answers: the decoder reports nothing for an empty transaction
+        bus.start();
+        bus.byte(0x30 << 1, false);
+        bus.stop();
+
+        // Slave NACKs the third data byte and the master stops there
+        bus.start();
+        bus.byte(0x50 << 1, true);
+        bus.byte(0x01, true);
+        bus.byte(0x02, true);
+        bus.byte(0x03, false);
+        bus.stop();
+        bus.expect(0x50, false, {0x01, 0x02, 0x03});
+
+        bus.readRegister(0x48, 0x00, {0x12, 0x34});
+    }
+}
+
+static void buildLongTransfers(BusBuilder& bus, AddressFilter& filter) {
+    defaultFilter(filter);
+    bus.write(0x50, pattern(I2CDecoder::MAX_DATA_SIZE, 1));
+    bus.write(0x50, pattern(I2CDecoder::MAX_DATA_SIZE + 16, 2));  // Truncated to the buffer
+    bus.readRegister(0x50, 0x00, pattern(I2CDecoder::MAX_DATA_SIZE, 3));
+    bus.read(0x51, pattern(200, 4));
+}
+
+static void buildGlitches(BusBuilder& bus, AddressFilter& filter) {
+    defaultFilter(filter);
+    for (int i = 0; i < 20; i++) {
+        bus.start();
+        bus.byte(0x48 << 1, true);
+        // Spikes on SDA while SCL is low must not look like START or STOP
+        bus.idle(1000);
+        bus.glitch(true, 300);
+        bus.idle(1000);
+        bus.byte(0x01, true);
+        bus.byte((uint8_t)i, true);
+        bus.stop();
+        bus.expect(0x48, false, {0x01, (uint8_t)i});
+        bus.idle(5000);
+    }
+}
+
+// Two masters start together; the one that sends a 1 while the bus reads 0
+// loses arbitration and releases SDA, so only the winner's frame is on the bus
+static void arbitrate(BusBuilder& bus, uint8_t addressA, const std::vector<uint8_t>& dataA,
+                      uint8_t addressB, const std::vector<uint8_t>& dataB) {
+    uint8_t frameA = addressA << 1;
+    uint8_t frameB = addressB << 1;
+    bool lostA = false;
+    bool lostB = false;
+
+    bus.start();
+    for (int i = 7; i >= 0; i--) {
+        bool bitA = lostA || ((frameA >> i) & 1);
+        bool bitB = lostB || ((frameB >> i) & 1);
+        bool line = bitA && bitB;
+        lostA = lostA || (bitA && !line);
+        lostB = lostB || (bitB && !line);
+        bus.bit(line);
+    }
+    bus.bit(false);  // Winner's slave ACKs
+
+    bool winnerIsA = !lostA;
+    const std::vector<uint8_t>& data = winnerIsA ? dataA : dataB;
+    for (uint8_t value : data) {
+        bus.byte(value, true);
+    }
+    bus.stop();
+    bus.expect(winnerIsA ? addressA : addressB, false, data);
+
+    // The loser retries once the bus is free
+    bus.write(winnerIsA ? addressB : addressA, winnerIsA ? dataB : dataA);
+}
+
+static void buildMultiMaster(BusBuilder& bus, AddressFilter& filter) {
+    defaultFilter(filter);
+    for (int i = 0; i < 20; i++) {
+        arbitrate(bus, 0x50, {0x00, (uint8_t)i}, 0x48, {0x01, 0x60});
+        arbitrate(bus, 0x20, pattern(3, i), 0x21, pattern(2, i));
+
+        // Masters with different clocks sharing the bus back to back
+        bus.setClock(100000);
+        bus.readRegister(0x68, 0x3B, pattern(6, i));
+        bus.setClock(62500);
+        bus.write(0x3C, pattern(8, i));
+        bus.setClock(100000);
+    }
+}
+
+static void buildFiltered(BusBuilder& bus, AddressFilter& filter) {
+    filter.addRange(0x48, 0x48, {SAMPLE_DECIMATE, 2});
+    filter.addRange(0x60, 0x6F);
+    for (int i = 0; i < 40; i++) {
+        bus.write(0x48, {(uint8_t)i});
+        if (i % 2 == 1) {
+            bus.expected.pop_back();  // Decimation keeps every other one
+        }
+        bus.write(0x50, {(uint8_t)i});
+        bus.expected.pop_back();  // Outside every range
+        bus.readRegister(0x68, 0x3B, pattern(2, i));
+    }
+}
+
+static const Scenario SCENARIOS[] = {
+    {"poll-100k", 100000, buildSensorPolling, "Register reads and writes at 100 kHz", nullptr},
+    {"poll-400k", 400000, buildSensorPolling, "Register reads and writes at 400 kHz",
+     "edges closer than the decoder's debounce window are discarded"},
+    {"stretch", 100000, buildClockStretch, "Slave clock stretching after every ACK", nullptr},
+    {"nack", 100000, buildNacks, "Address and data NACKs", nullptr},
+    {"long", 100000, buildLongTransfers, "Transfers at and beyond the decoder buffer", nullptr},
+    {"glitch", 100000, buildGlitches, "Sub-microsecond SDA spikes while SCL is low", nullptr},
+    {"multi-master", 100000, buildMultiMaster, "Arbitration and mixed-speed masters", nullptr},
+    {"filter", 100000, buildFiltered, "Address ranges and decimation", nullptr},
+};
+static const size_t SCENARIO_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+static double secondsSince(const struct timespec& start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// Host cost of decode + filter per edge, for comparison with the device budget
+static double measureHostNsPerEdge() {
+    BusBuilder bus(100000);
+    AddressFilter filter;
+    buildSensorPolling(bus, filter);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned long edges = 0;
+    while (secondsSince(start) < 0.2) {
+        AddressFilter fresh;
+        defaultFilter(fresh);
+        edges += runIdeal(bus.edges, fresh).edgesDelivered;
+    }
+    return secondsSince(start) * 1e9 / edges;
+}
+
+// Highest clock at which a sustained polling burst decodes exactly, found by
+// bisection; model is nullptr for ideal edge delivery
+static void runSweep(const char* label, const DeviceModel* model) {
+    uint32_t low = 10000;
+    uint32_t high = 3400000;
+    std::string lastError;
+
+    while (high - low > 1000) {
+        uint32_t clock = low + (high - low) / 2;
+        BusBuilder bus(clock);
+        AddressFilter filter;
+        buildSensorPolling(bus, filter);
+
+        std::string error;
+        PipelineResult result = model ? runDevice(bus.edges, filter, *model) : runIdeal(bus.edges, filter);
+        if (compare(bus.expected, result, false, error)) {
+            low = clock;
+        } else {
+            high = clock;
+            lastError = error;
+        }
+    }
+
+    BusBuilder bus(low);
+    AddressFilter filter;
+    buildSensorPolling(bus, filter);
+    double seconds = (bus.time() - bus.edges.front().timeNs) / 1e9;
+    printf("\n%s\n", label);
+    printf("  max clean clock:   %u Hz\n", low);
+    printf("  sustained edges:   %.0f edges/s (%.0f transactions/s)\n",
+           bus.edges.size() / seconds, bus.expected.size() / seconds);
+    printf("  first failure:     %u Hz, %s\n", high, lastError.c_str());
+}
+
+int main(int argc, char** argv) {
+    const char* only = nullptr;
+    bool sweep = false;
+    bool verbose = false;
+    DeviceModel model = {2500, 1500, 50000, 0, 15};  // 16-slot ring keeps one slot free
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            sweep = true;
+        } else if (strcmp(argv[i], "--isr-ns") == 0 && i + 1 < argc) {
+            model.isrNs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--isr-latency-ns") == 0 && i + 1 < argc) {
+            model.isrLatencyNs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--wake-us") == 0 && i + 1 < argc) {
+            model.wakeNs = strtoul(argv[++i], nullptr, 10) * 1000;
+            model.loopNs = 0;
+        } else if (strcmp(argv[i], "--loop-us") == 0 && i + 1 < argc) {
+            model.loopNs = strtoul(argv[++i], nullptr, 10) * 1000;
+        } else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            model.queueSize = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--scenario name] [--sweep] [--isr-ns ns] [--isr-latency-ns ns] "
+                            "[--wake-us us | --loop-us us] [--queue n] [-v]\n", argv[0]);
+            for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+                fprintf(stderr, "  %-13s %s\n", SCENARIOS[s].name, SCENARIOS[s].description);
+            }
+            return 2;
+        }
+    }
+
+    int failures = 0;
+    int run = 0;
+    for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+        const Scenario& scenario = SCENARIOS[s];
+        if (only && strcmp(only, scenario.name) != 0) {
+            continue;
+        }
+        run++;
+
+        BusBuilder bus(scenario.clockHz);
+        AddressFilter filter;
+        scenario.build(bus, filter);
+
+        std::string error;
+        PipelineResult result = runIdeal(bus.edges, filter);
+        bool passed = compare(bus.expected, result, verbose, error);
+        const char* verdict = passed ? "PASS" : "FAIL";
+        if (scenario.knownLimit) {
+            verdict = passed ? "XPASS" : "XFAIL";
+            error = scenario.knownLimit;
+        }
+        printf("%-13s %-5s %6zu edges, %4zu transactions, %3lu filtered\n",
+               scenario.name, verdict, bus.edges.size(), result.decoded.size(), result.filteredTransactions);
+        if (!passed) {
+            printf("    %s\n", error.c_str());
+        }
+        failures += passed == !scenario.knownLimit ? 0 : 1;
+    }
+    if (run == 0) {
+        fprintf(stderr, "unknown scenario '%s'\n", only);
+        return 2;
+    }
+
+    printf("\nhost decode+filter: %.1f ns/edge\n", measureHostNsPerEdge());
+    if (sweep) {
+        char label[128];
+        snprintf(label, sizeof(label), "device model (isr %u ns, latency %u ns, %s %u us, queue %zu):",
+                 model.isrNs, model.isrLatencyNs, model.loopNs ? "loop" : "wake",
+                 (model.loopNs ? model.loopNs : model.wakeNs) / 1000, model.queueSize);
+        runSweep("decoder, ideal edge delivery:", nullptr);
+        runSweep(label, &model);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+// Indexed capture store for long binary USB captures (firmware OUTPUT BINARY).
+//
+// import: decodes the COBS record stream from a tty, file or pipe and appends
+//         it to a segmented store directory
+// query:  selects records by time range, address, bus and direction using the
+//         store's time and address indexes, and exports CSV or pcap
+//         (DLT_I2C_LINUX, readable by Wireshark)
+// info:   segment count, record count and time range
+//
+// Build: g++ -std=c++17 -O2 -Isrc -Itools tools/i2c_store.cpp tools/CaptureStore.cpp src/BinaryFrame.cpp -o i2c_store
+// Usage: i2c_store import [--segment MB] store/ [/dev/ttyACM0 | capture.bin]   (stdin when omitted)
+//        i2c_store query store/ [--address 0x48] [--bus N] [--read | --write]
+//                              [--from us] [--to us] [--pcap] [-o output]
+//        i2c_store info store/
+
+#include <stdio.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "CaptureStore.h"
+
+struct ImportSession {
+    CaptureStoreWriter* writer;
+    bool failed;
+};
+
+struct ExportSession {
+    FILE* output;
+    bool pcap;
+};
+
+static void onRecord(void* context, const BinaryRecord& record) {
+    ImportSession* session = static_cast<ImportSession*>(context);
+    if (!session->failed && !session->writer->append(record)) {
+        perror("append");
+        session->failed = true;
+    }
+}
+
+static void onStoredRecord(void* context, const StoredRecord& record) {
+    ExportSession* session = static_cast<ExportSession*>(context);
+    if (session->pcap) {
+        CaptureExport::writePcap(session->output, record);
+    } else {
+        CaptureExport::writeCsv(session->output, record);
+    }
+}
+
+static int openInput(const char* path) {
+    if (!path) {
+        return STDIN_FILENO;
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    // USB CDC ignores the baud rate, but the line discipline must be raw
+    struct termios tty;
+    if (isatty(fd) && tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        tty.c_cc[VMIN] = 1;
+        tty.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    return fd;
+}
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+// No SA_RESTART: a blocked read() returns EINTR so the import can seal its segment
+static void installStopHandlers() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+static double secondsSince(const struct timespec& start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static int usage(const char* program) {
+    fprintf(stderr,
+            "usage: %s import [--segment MB] store [input]\n"
+            "       %s query store [--address 0x48] [--bus N] [--read | --write] [--from us] [--to us] [--pcap] [-o output]\n"
+            "       %s info store\n",
+            program, program, program);
+    return 2;
+}
+
+static int runImport(int argc, char** argv) {
+    const char* storePath = nullptr;
+    const char* inputPath = nullptr;
+    size_t segmentSize = CaptureStoreWriter::DEFAULT_SEGMENT_SIZE;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--segment") == 0 && i + 1 < argc) {
+            segmentSize = strtoul(argv[++i], nullptr, 10) << 20;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            return usage(argv[0]);
+        } else if (!storePath) {
+            storePath = argv[i];
+        } else {
+            inputPath = argv[i];
+        }
+    }
+    if (!storePath) {
+        return usage(argv[0]);
+    }
+
+    CaptureStoreWriter writer;
+    if (!writer.open(storePath, segmentSize)) {
+        return 1;
+    }
+    int input = openInput(inputPath);
+    if (input < 0) {
+        return 1;
+    }
+
+    ImportSession session = {&writer, false};
+    BinaryFrameReader reader;
+    reader.setRecordHandler(onRecord, &session);
+    installStopHandlers();
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    double lastReport = 0;
+
+    uint8_t chunk[16384];
+    ssize_t length;
+    while (!session.failed && !stopRequested && (length = read(input, chunk, sizeof(chunk))) > 0) {
+        reader.feed(chunk, length);
+
+        double elapsed = secondsSince(start);
+        if (elapsed - lastReport >= 1.0) {
+            // A killed import then loses at most a second; the next open
+            // indexes the unsealed segment
+            session.failed = !writer.flush();
+            fprintf(stderr, "\r%llu records in %u segments, %lu bad frames, %lu lost",
+                    writer.getRecordCount(), writer.getSegmentCount(),
+                    reader.getBadFrameCount(), reader.getLostRecordCount());
+            lastReport = elapsed;
+        }
+    }
+
+    if (input != STDIN_FILENO) {
+        close(input);
+    }
+    bool sealed = writer.close();
+    fprintf(stderr, "\n%llu records in %u segments, %lu bad frames, %lu lost records\n",
+            writer.getRecordCount(), writer.getSegmentCount(),
+            reader.getBadFrameCount(), reader.getLostRecordCount());
+    return session.failed || !sealed ? 1 : 0;
+}
+
+static int runQuery(int argc, char** argv) {
+    const char* storePath = nullptr;
+    const char* outputPath = nullptr;
+    CaptureQuery query;
+    ExportSession session = {stdout, false};
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--address") == 0 && i + 1 < argc) {
+            query.address = strtol(argv[++i], nullptr, 16) & 0x7F;
+        } else if (strcmp(argv[i], "--bus") == 0 && i + 1 < argc) {
+            query.busId = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--read") == 0) {
+            query.direction = 1;
+        } else if (strcmp(argv[i], "--write") == 0) {
+            query.direction = 0;
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            query.from = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            query.to = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--pcap") == 0) {
+            session.pcap = true;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (argv[i][0] == '-' || storePath) {
+            return usage(argv[0]);
+        } else {
+            storePath = argv[i];
+        }
+    }
+    if (!storePath) {
+        return usage(argv[0]);
+    }
+
+    CaptureStoreReader reader;
+    if (!reader.open(storePath)) {
+        return 1;
+    }
+
+    if (outputPath) {
+        session.output = fopen(outputPath, "wb");
+        if (!session.output) {
+            perror(outputPath);
+            return 1;
+        }
+    }
+    static char outputBuffer[1 << 20];
+    setvbuf(session.output, outputBuffer, _IOFBF, sizeof(outputBuffer));
+
+    if (session.pcap) {
+        CaptureExport::writePcapHeader(session.output);
+    } else {
+        CaptureExport::writeCsvHeader(session.output);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned long long count = reader.query(query, onStoredRecord, &session);
+    double elapsed = secondsSince(start);
+
+    fflush(session.output);
+    if (session.output != stdout) {
+        fclose(session.output);
+    }
+    fprintf(stderr, "%llu of %llu records matched in %.3f s\n", count, reader.getRecordCount(), elapsed);
+    return 0;
+}
+
+static int runInfo(int argc, char** argv) {
+    if (argc != 3) {
+        return usage(argv[0]);
+    }
+
+    CaptureStoreReader reader;
+    if (!reader.open(argv[2])) {
+        return 1;
+    }
+
+    printf("segments:   %zu (%zu unindexed)\n", reader.getSegmentCount(), reader.getUnindexedSegmentCount());
+    printf("records:    %llu\n", reader.getRecordCount());
+    printf("time range: %llu - %llu us\n",
+           (unsigned long long)reader.getFirstTimestamp(), (unsigned long long)reader.getLastTimestamp());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        return usage(argv[0]);
+    }
+    if (strcmp(argv[1], "import") == 0) {
+        return runImport(argc, argv);
+    }
+    if (strcmp(argv[1], "query") == 0) {
+        return runQuery(argc, argv);
+    }
+    if (strcmp(argv[1], "info") == 0) {
+        return runInfo(argc, argv);
+    }
+    return usage(argv[0]);
+}